@@ -0,0 +1,311 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+import argparse
+import json
+import random
+import re
+import subprocess
+
+# Clock of the board.
+SYSCLK = 33177600
+
+# ucsim counts the clocks of a 12T 8051, cycles are reported in machine
+# cycles, which is an upper bound of the 1T cycles of STC8G.
+CLOCKS_PER_CYCLE = 12
+
+# Timer0 period(cycles), 1ms.
+TICK_CYCLES = 33178
+
+# Byte time at the max baud rate(cycles), 10 bits at 115200.
+BYTE_CYCLES = SYSCLK * 10 // 115200
+
+# Max pulses per second on the speed input.
+MAX_SPEED_HZ = 1000
+
+# Max speed output(Hz), limited by the min half period of 1024 PCA counts.
+MAX_SPEED_OUTPUT_HZ = SYSCLK / 6 / 2048
+
+# PCA interrupts per second, overflows, 3 edges of PWM input every 20ms and
+# 2 matches a period of speed output.
+PCA_INTERRUPT_HZ = SYSCLK / 6 / 65536 + 3 * 50 + 2 * MAX_SPEED_OUTPUT_HZ
+
+# Routines measured, each is called from the main loop with the SFRs and
+# variables of the scenario set, the cycles until it returns are counted.
+# (name, scenario, SFRs, variables in data(symbol, size, value)).
+SCENARIOS = (
+    ("timer0_isr", "tick", {}, ()),
+    ("timer0_isr", "sampling", {},
+     (("l_speed_sub_window_tick", 1, 49), )),
+    ("int1_isr", "pulse", {}, ()),
+    ("pca_isr", "overflow", {0xD8: 0xC0}, ()),
+    ("pca_isr", "capture", {
+        0xD8: 0x41,
+        0xDA: 0x31
+    }, (("l_pwm_capture_state", 1, 0x03), )),
+    ("pca_isr", "match", {
+        0xD8: 0x42,
+        0xDB: 0x4D
+    }, (("l_speed_output_half_period", 4, 22118), )),
+    ("serial_isr", "receive", {
+        0x98: 0x51,
+        0x99: 0xA5
+    }, ()),
+    ("serial_isr", "sent", {0x98: 0x52}, ()),
+    ("timer0_isr_second_stage", "idle", {}, ()),
+    ("timer0_isr_second_stage", "speed", {}, (("time0_flags", 1, 0x01), )),
+    ("timer0_isr_second_stage", "window", {}, (
+        ("time0_flags", 1, 0x01),
+        ("l_speed_method", 1, 0x01),
+    )),
+)
+
+# Budgets from the hardware, checked regardless of the baseline.
+BUDGETS = {
+    "timer0_isr": TICK_CYCLES // 4,
+    "int1_isr": TICK_CYCLES // 4,
+    "pca_isr": TICK_CYCLES // 4,
+    "serial_isr": TICK_CYCLES // 2,
+    "timer0_isr_second_stage": BYTE_CYCLES,
+    "timer0_latency": BYTE_CYCLES // 2,
+    "utilization": 50,
+}
+
+# Allowed regression against the baseline.
+TOLERANCE = 0.05
+
+# Number of samples of interrupt latency.
+LATENCY_SAMPLES = 200
+
+SFR_SP = 0x81
+SFR_TCON = 0x88
+
+
+class S51:
+    """
+    ucsim s51 driven by its command console.
+    """
+
+    def __init__(self, executable, ihx):
+        self.__process = subprocess.Popen((executable, "-t", "8052", ihx),
+                                          stdin=subprocess.PIPE,
+                                          stdout=subprocess.PIPE,
+                                          stderr=subprocess.STDOUT)
+        self.__read_until_prompt()
+
+    def close(self):
+        self.__process.stdin.write(b"quit\n")
+        self.__process.stdin.flush()
+        self.__process.wait()
+
+    def __read_until_prompt(self):
+        data = b""
+        while re.search(rb"(^|\n)\d*> $", data) is None:
+            byte = self.__process.stdout.read(1)
+            if len(byte) == 0:
+                raise RuntimeError("s51 exited:\n%s" % data.decode())
+            data += byte
+
+        return data.decode(errors="replace")
+
+    def command(self, cmd):
+        self.__process.stdin.write((cmd + "\n").encode())
+        self.__process.stdin.flush()
+        return self.__read_until_prompt()
+
+    def state(self):
+        output = self.command("state")
+        pc = re.search(r"PC=\s*0x([0-9a-fA-F]+)", output)
+        clocks = re.search(r"Total time since last reset=.*\((\d+) clks\)",
+                           output)
+        if pc is None or clocks is None:
+            raise RuntimeError("Unknown output of state:\n%s" % output)
+
+        return int(pc.group(1), 16), int(clocks.group(1))
+
+    def read(self, memory, addr):
+        output = self.command("dump %s 0x%x 0x%x" % (memory, addr, addr))
+        match = re.search(r"0x0*%x\s+([0-9a-fA-F]{2})" % addr, output)
+        if match is None:
+            raise RuntimeError("Unknown output of dump:\n%s" % output)
+
+        return int(match.group(1), 16)
+
+    def write(self, memory, addr, value):
+        self.command("set memory %s 0x%x 0x%x" % (memory, addr, value))
+
+    def run_to(self, addr):
+        self.command("break 0x%x" % addr)
+        self.command("run")
+        self.command("delete")
+        pc, clocks = self.state()
+        if pc != addr:
+            raise RuntimeError("Stopped at 0x%x instead of 0x%x." % (pc, addr))
+
+        return clocks
+
+    def call(self, addr):
+        """
+        Call routine from current PC as an interrupt does, returns the cycles
+        until it returns.
+        """
+        ret, begin = self.state()
+
+        # Push return address.
+        sp = self.read("sfr", SFR_SP)
+        self.write("iram", sp + 1, ret & 0xFF)
+        self.write("iram", sp + 2, ret >> 8)
+        self.write("sfr", SFR_SP, sp + 2)
+        self.command("pc 0x%x" % addr)
+
+        return (self.run_to(ret) - begin) // CLOCKS_PER_CYCLE
+
+
+def load_symbols(cdb_file):
+    """
+    Load the addresses of global and static symbols from .cdb file of SDCC.
+    """
+    symbols = {}
+    with open(cdb_file, "r") as f:
+        for line in f:
+            match = re.match(
+                r"^L:(?:G|F\w+)\$(\w+)\$[0-9_]+\$[0-9]+:([0-9A-Fa-f]+)$",
+                line.strip())
+            if match is not None and match.group(1) not in symbols:
+                symbols[match.group(1)] = int(match.group(2), 16)
+
+    return symbols
+
+
+def symbol(symbols, name):
+    if name not in symbols:
+        raise RuntimeError(
+            "Symbol \"%s\" not found, update the scenarios." % name)
+
+    return symbols[name]
+
+
+def enter_main_loop(s51, symbols):
+    """
+    Reset and run to the main loop, Timer0 is stopped so the interrupts are
+    only raised by the benchmark.
+    """
+    s51.command("reset")
+    s51.run_to(symbol(symbols, "timer0_isr_second_stage"))
+    s51.write("sfr", SFR_TCON, s51.read("sfr", SFR_TCON) & 0xCF)
+
+
+def measure_routines(s51, symbols):
+    results = {}
+    for name, scenario, sfrs, variables in SCENARIOS:
+        enter_main_loop(s51, symbols)
+        for addr, value in sfrs.items():
+            s51.write("sfr", addr, value)
+        for var, size, value in variables:
+            addr = symbol(symbols, var)
+            for i in range(size):
+                s51.write("iram", addr + i, (value >> (8 * i)) & 0xFF)
+
+        cycles = s51.call(symbol(symbols, name))
+        print("%-24s %-10s %6d cycles" % (name, scenario, cycles))
+        results[name] = max(results.get(name, 0), cycles)
+
+    return results
+
+
+def measure_latency(s51, symbols):
+    """
+    Raise Timer0 interrupt at random points of the main loop, returns the
+    max cycles until the ISR is entered.
+    """
+    enter_main_loop(s51, symbols)
+    isr = symbol(symbols, "timer0_isr")
+    rand = random.Random(0)
+    latency = 0
+    for _ in range(LATENCY_SAMPLES):
+        s51.command("step %d" % rand.randint(1, 200))
+        _, begin = s51.state()
+        s51.write("sfr", SFR_TCON, s51.read("sfr", SFR_TCON) | 0x20)
+        latency = max(latency,
+                      (s51.run_to(isr) - begin) // CLOCKS_PER_CYCLE)
+
+        # Let the ISR return.
+        s51.command("step 1")
+        s51.run_to(symbol(symbols, "timer0_isr_second_stage"))
+
+    print("%-24s %-10s %6d cycles" % ("timer0_latency", "worst", latency))
+    return latency
+
+
+def check(results, baseline):
+    ok = True
+    for name, value in sorted(results.items()):
+        if name in BUDGETS and value > BUDGETS[name]:
+            print("FAIL %s = %d, over budget %d." %
+                  (name, value, BUDGETS[name]))
+            ok = False
+        if name in baseline and value > baseline[name] * (1 + TOLERANCE):
+            print("FAIL %s = %d, regressed from baseline %d." %
+                  (name, value, baseline[name]))
+            ok = False
+
+    return ok
+
+
+def main():
+    #Parse argument
+    parser = argparse.ArgumentParser(
+        description="Measure the cycles of ISRs under ucsim.")
+    parser.add_argument("ihx", type=str, help="Firmware .ihx file.")
+    parser.add_argument("cdb", type=str, help="Firmware .cdb file.")
+    parser.add_argument("--s51", type=str, default="s51", help="s51.")
+    parser.add_argument("--baseline", type=str, help="Baseline file.")
+    parser.add_argument("--update-baseline",
+                        action="store_true",
+                        help="Write results to baseline file.")
+
+    args = parser.parse_args()
+
+    # Measure.
+    symbols = load_symbols(args.cdb)
+    s51 = S51(args.s51, args.ihx)
+    try:
+        results = measure_routines(s51, symbols)
+        results["timer0_latency"] = measure_latency(s51, symbols)
+    finally:
+        s51.close()
+
+    # CPU utilization in worst case, Timer0 ticks, a byte received at max
+    # baud rate, max speed input and PCA interrupts.
+    results["utilization"] = int(
+        100 * (results["timer0_isr"] / TICK_CYCLES +
+               results["serial_isr"] / BYTE_CYCLES +
+               results["int1_isr"] * MAX_SPEED_HZ / SYSCLK +
+               results["pca_isr"] * PCA_INTERRUPT_HZ / SYSCLK) + 0.5)
+    print("%-24s %-10s %6d %%" %
+          ("utilization", "worst", results["utilization"]))
+
+    # Check.
+    baseline = {}
+    if args.baseline is not None:
+        if args.update_baseline:
+            with open(args.baseline, "w") as f:
+                json.dump(results, f, indent=4, sort_keys=True)
+                f.write("\n")
+            return 0
+
+        try:
+            with open(args.baseline, "r") as f:
+                baseline = json.load(f)
+        except FileNotFoundError:
+            # Regressions would pass unnoticed.
+            print("FAIL baseline \"%s\" not found, "
+                  "generate it with --update-baseline." % args.baseline)
+            check(results, baseline)
+            return 1
+
+    return 0 if check(results, baseline) else 1
+
+
+if __name__ == "__main__":
+    exit(main())
@@ -5,9 +5,9 @@
 #include <command.h>
 #include <platform.h>
 
-/// 17μs a tick.
 /**
  * @brief       Initialize clock.
+ * Timer0 ticks every 1ms.
  */
 extern void clock_init();
 
@@ -62,7 +62,69 @@ extern void set_current_mode(uint8_t mode);
  */
 extern uint16_t input_speed();
 
+/**
+ * @brief       Set the method to measure input speed.
+ *
+ * @param[in]   method  SPEED_METHOD_PERIOD or SPEED_METHOD_COUNTING.
+ */
+extern void set_speed_method(uint8_t method);
+
+/**
+ * @brief       Set the window to count edges.
+ *
+ * @param[in]   sub_windows Sub-windows of SPEED_SUB_WINDOW_MS in the window,
+ *                          1 to SPEED_WINDOW_MAX_MS / SPEED_SUB_WINDOW_MS.
+ */
+extern void set_speed_window(uint8_t sub_windows);
+
+/**
+ * @brief       Get input pwm.
+ *
+ * @return      Duty cycle, 0-100.
+ */
+extern uint8_t input_pwm();
+
+/**
+ * @brief       Get input pwm frequency.
+ *
+ * @return      Frequency(HZ), 0 if the level is constant.
+ */
+extern uint16_t input_pwm_frequency();
+
+/**
+ * @brief       Set output pwm.
+ *
+ * @param[in]   duty_cycle  Duty cycle, 0-100.
+ */
+extern void set_output_pwm(uint8_t duty_cycle);
+
+/**
+ * @brief       Get output pwm.
+ *
+ * @return      Duty cycle, 0-100.
+ */
+extern uint8_t output_pwm();
+
+/**
+ * @brief       Set output speed, applied by timer0_isr_second_stage().
+ *
+ * @param[in]   speed       Speed(1/16 Hz), 0 to stop.
+ */
+extern void set_output_speed(uint32_t speed);
+
+/**
+ * @brief       Get output speed.
+ *
+ * @return      Speed(1/16 Hz).
+ */
+extern uint32_t output_speed();
+
 /**
  * @brief       INT1 ISR.
  */
 extern void int1_isr(void) __interrupt INT_INT3;
+
+/**
+ * @brief       PCA ISR.
+ */
+extern void pca_isr(void) __interrupt INT_PCA;
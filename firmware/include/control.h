@@ -0,0 +1,22 @@
+#pragma once
+
+#include <types.h>
+
+#include <command.h>
+
+/**
+ * @brief       Initialize, load config from eeprom_config().
+ */
+extern void control_init();
+
+/**
+ * @brief       Load config, called when the config is loaded or written.
+ *
+ * @param[in]   config      Config.
+ */
+extern void control_load_config(const struct FirmwareConfig *config);
+
+/**
+ * @brief       Run a step of the control loop, called in main loop.
+ */
+extern void control_step();
@@ -3,6 +3,7 @@
 #include <types.h>
 
 #include <command.h>
+#include <platform.h>
 
 #define RECORD_SIZE 64
 
@@ -22,15 +23,21 @@ _Static_assert(sizeof(struct config_record) < RECORD_SIZE,
 void eeprom_init();
 
 /**
- * @brief       Read record.
+ * @brief       Get config, read from RAM.
  *
- * @param[out]  record      Record.
+ * @return      Config.
  */
-void eeprom_read_record(struct config_record *record);
+__xdata struct FirmwareConfig *eeprom_config();
 
 /**
- * @brief       Write record.
+ * @brief       Set config, written back by eeprom_flush().
  *
- * @param[out]  record      Record.
+ * @param[in]   config      Config.
  */
-void eeprom_write_record(struct config_record *record);
+void eeprom_set_config(const struct FirmwareConfig *config);
+
+/**
+ * @brief       Flush config to eeprom if dirty, called in main loop when
+ *              serial is idle.
+ */
+void eeprom_flush();
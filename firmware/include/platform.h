@@ -4,12 +4,36 @@
 
 // Definations of STC8G1K08-36I-SOP8
 // IRC = 33.1776 MHz
+#define SYSCLK ((uint32_t)33177600)
 
-#if defined EDITOR_AUTO_COMPLETE
+#if defined BUILD_SIMULATOR
+    // Native build, SFRs are variables of the simulator.
+    #include <simulator.h>
+
+    #define __data
+    #define __idata
+    #define __xdata
+    #define __code
+    #define __at(addr)
+    #if defined SIMULATOR_DEFINE_SFR
+        #define __sfr  volatile uint8_t
+        #define __sbit volatile uint8_t
+    #else
+        #define __sfr  extern volatile uint8_t
+        #define __sbit extern volatile uint8_t
+    #endif
+    #define __interrupt
+    #define INT_TIMER0
+    #define INT_INT3
+    #define INT_UART1
+    #define INT_PCA
+
+#elif defined EDITOR_AUTO_COMPLETE
     // Auto-complete.
     #define __data
     #define __idata
     #define __xdata
+    #define __code
     #define __at(addr)
     #define __sfr  uint8_t
     #define __sbit uint8_t
@@ -42,7 +66,11 @@ __sbit __at(0xB7) P3_7;
 __sfr __at(0xB1) P3M1;
 __sfr __at(0xB2) P3M0;
 
-#define P3PU (*((uint8_t *)0xFE12))
+#if defined BUILD_SIMULATOR
+__sfr P3PU;
+#else
+    #define P3PU (*((uint8_t *)0xFE12))
+#endif
 
 // P5
 __sfr  __at(0xC8) P5;
@@ -52,13 +80,23 @@ __sbit __at(0xCD) P5_5;
 __sfr __at(0xC9) P5M1;
 __sfr __at(0xCA) P5M0;
 
-#define P5PU (*((uint8_t *)0xFE15))
+#if defined BUILD_SIMULATOR
+__sfr P5PU;
+#else
+    #define P5PU (*((uint8_t *)0xFE15))
+#endif
 
 // Serial
 __sfr __at(0x98) SCON;
 __sfr __at(0x99) SBUF;
 __sfr __at(0x87) PCON;
 
+#if defined BUILD_SIMULATOR
+    #define UART_SEND(byte) sim_uart_send(byte)
+#else
+    #define UART_SEND(byte) (SBUF = (byte))
+#endif
+
 // Timer
 __sfr __at(0x88) TCON;
 __sfr __at(0x89) TMOD;
@@ -68,6 +106,25 @@ __sfr __at(0x8C) TH0;
 __sfr __at(0x8D) TH1;
 __sfr __at(0x8E) AUXR;
 
+// PCA
+__sfr __at(0xD8) CCON;
+__sfr __at(0xD9) CMOD;
+__sfr __at(0xE9) CL;
+__sfr __at(0xF9) CH;
+__sfr __at(0xDA) CCAPM0;
+__sfr __at(0xEA) CCAP0L;
+__sfr __at(0xFA) CCAP0H;
+__sfr __at(0xDB) CCAPM1;
+__sfr __at(0xEB) CCAP1L;
+__sfr __at(0xFB) CCAP1H;
+__sfr __at(0xDC) CCAPM2;
+__sfr __at(0xEC) CCAP2L;
+__sfr __at(0xFC) CCAP2H;
+__sfr __at(0xF4) PCA_PWM2;
+
+/// PCA counts SYSCLK / 6.
+#define PCA_CLOCK (SYSCLK / 6)
+
 // Interrupt
 __sfr __at(0xA8) IE;
 __sfr __at(0xAF) IE2;
@@ -90,12 +147,29 @@ __sfr __at(0xC6) IAP_TRIG;
 __sfr __at(0xC7) IAP_CONTR;
 __sfr __at(0xF5) IAP_TPS;
 
+#if defined BUILD_SIMULATOR
+    #define IAP_TRIGGER() sim_iap_trigger()
+#else
+    #define IAP_TRIGGER()    \
+        do {                 \
+            IAP_TRIG = 0x5A; \
+            IAP_TRIG = 0xA5; \
+        } while (0)
+#endif
+
 // Board
 #define PWM_INPUT    P3_2
 #define SPEED_OUTPUT P3_3
 #define SPEED_INPUT  P5_5
 #define PWM_OUTPUT   P5_4
 
+// Called in main loop when there is nothing to do.
+#if defined BUILD_SIMULATOR
+    #define PLATFORM_IDLE() sim_step()
+#else
+    #define PLATFORM_IDLE()
+#endif
+
 // Generate bit mask.
 #define MASK(type, value) (~((type)(value)))
 
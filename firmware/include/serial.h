@@ -4,7 +4,7 @@
 
 /**
  * @brief       Initialize serial.
- * Baud rate = 9600.
+ * Baud rate = SERIAL_DEFAULT_BAUD_RATE.
  */
 extern void serial_init();
 
@@ -13,6 +13,43 @@ extern void serial_init();
  */
 extern void enable_serial();
 
+/**
+ * @brief       Parse bytes received and handle commands.
+ * Called in main loop, serial ISR only stores the bytes received.
+ */
+extern void serial_poll();
+
+/**
+ * @brief       Check if serial is idle.
+ * No frame is being received or sent and no byte has been received in 50ms,
+ * so the CPU can be held for a while without losing bytes.
+ *
+ * @return      \c true if idle, otherwise returns \c false.
+ */
+extern bool serial_idle();
+
+/**
+ * @brief       Switch baud rate requested.
+ * Called in main loop, the baud rate is switched when all the bytes queued
+ * before have been sent by serial ISR.
+ */
+extern void serial_switch_baud_rate();
+
+/**
+ * @brief       Check the link after switching baud rate.
+ * Called in main loop, falls back to SERIAL_DEFAULT_BAUD_RATE if the link is
+ * not confirmed in SERIAL_LINK_CHECK_TIMEOUT_MS after switching baud rate.
+ */
+extern void serial_check_link();
+
+/**
+ * @brief       Push telemetry if subscribed.
+ * Called in main loop, a frame is pushed each time the interval subscribed
+ * has elapsed, so the boot time and the PWM keep updating while the fan is
+ * stopped.
+ */
+extern void serial_push_telemetry();
+
 /**
  * @brief       Serial ISR.
  */
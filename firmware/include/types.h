@@ -1,5 +1,10 @@
 #pragma once
 
+#if defined BUILD_SIMULATOR
+    // Native build, use the fixed width types of the host.
+    #include <stdint.h>
+
+#else
 typedef unsigned char uint8_t;
 _Static_assert(sizeof(uint8_t) == 1, "Wrong size of type!");
 
@@ -18,6 +23,8 @@ _Static_assert(sizeof(uint32_t) == 4, "Wrong size of type!");
 typedef long int32_t;
 _Static_assert(sizeof(int32_t) == 4, "Wrong size of type!");
 
+#endif
+
 typedef int8_t bool;
 #define true 1
 #define false 0
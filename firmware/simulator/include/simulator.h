@@ -0,0 +1,83 @@
+#pragma once
+
+#include <types.h>
+
+/**
+ * @brief       Options of simulator.
+ */
+struct sim_options {
+    double      speed;       ///< Virtual time / wall time, 0 for no limit.
+    uint32_t    fan_hz;      ///< Pulses per second on INT3, 0 for none.
+    uint32_t    pwm_hz;      ///< Frequency of PWM input, 0 for constant.
+    uint8_t     pwm_duty;    ///< Duty cycle of PWM input, 0-100.
+    const char *eeprom_file; ///< File to keep eeprom, NULL for none.
+};
+
+/**
+ * @brief       Entry of firmware, \c main of firmware/source/main.c.
+ */
+extern int firmware_main();
+
+/**
+ * @brief       Initialize simulator.
+ *
+ * @param[in]   options     Options.
+ *
+ * @return      On success, the method returns 0, otherwise returns -1.
+ */
+extern int sim_init(const struct sim_options *options);
+
+/**
+ * @brief       Run the virtual clock to next event and call the ISRs.
+ * Called in main loop of firmware by PLATFORM_IDLE().
+ */
+extern void sim_step();
+
+/**
+ * @brief       Get virtual time.
+ *
+ * @return      Clock cycles since boot.
+ */
+extern uint64_t sim_cycles();
+
+/**
+ * @brief       Open the pseudo-terminal of simulated UART.
+ *
+ * @return      On success, the method returns 0, otherwise returns -1.
+ */
+extern int sim_uart_open();
+
+/**
+ * @brief       Start sending byte, called when firmware writes SBUF.
+ *
+ * @param[in]   byte        Byte to send.
+ */
+extern void sim_uart_send(uint8_t byte);
+
+/**
+ * @brief       Get the cycle of next UART event.
+ *
+ * @param[in]   now         Current cycle.
+ *
+ * @return      Cycle of next event, UINT64_MAX if none.
+ */
+extern uint64_t sim_uart_next_event(uint64_t now);
+
+/**
+ * @brief       Run UART to cycle.
+ *
+ * @param[in]   now         Current cycle.
+ */
+extern void sim_uart_update(uint64_t now);
+
+/**
+ * @brief       Load eeprom.
+ *
+ * @param[in]   file        File to keep eeprom, NULL for none.
+ */
+extern void sim_iap_init(const char *file);
+
+/**
+ * @brief       Run IAP command, called when firmware triggers IAP.
+ */
+extern void sim_iap_trigger();
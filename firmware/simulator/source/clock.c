@@ -0,0 +1,361 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <clock_io.h>
+#include <platform.h>
+#include <serial.h>
+#include <simulator.h>
+
+/// Max cycles of a step, the pseudo-terminal is polled at least once a step.
+#define MAX_STEP_CYCLES (SYSCLK / 1000)
+
+/// Pacing is skipped while the virtual clock is ahead less than this(ns).
+#define MIN_SLEEP_NS 1000000
+
+static struct sim_options l_options; ///< Options.
+static uint64_t           l_cycles = 0;       ///< Virtual time.
+static volatile sig_atomic_t l_stop = 0;      ///< Stop requested.
+static struct timespec       l_start_time;    ///< Wall time of boot.
+
+// Timer0.
+static bool     l_timer0_running = false; ///< Timer0 is running.
+static uint32_t l_timer0_reload  = 0;     ///< Reload value.
+static uint32_t l_timer0_count   = 0;     ///< Counter.
+static uint64_t l_timer0_cycles  = 0;     ///< Cycle of last count.
+
+// PCA.
+static bool     l_pca_running = false; ///< PCA is running.
+static uint32_t l_pca_count   = 0;     ///< Counter.
+static uint64_t l_pca_cycles  = 0;     ///< Cycle of last count.
+
+// Speed input.
+static uint64_t l_fan_next_cycle = 0; ///< Cycle of next pulse.
+
+// PWM input.
+static uint64_t l_pwm_next_cycle = 0; ///< Cycle of next edge, 0 for none.
+
+/**
+ * @brief       Signal handler.
+ *
+ * @param[in]   sig     Signal.
+ */
+static void on_signal(int sig)
+{
+    (void)sig;
+    l_stop = 1;
+}
+
+/**
+ * @brief       Initialize simulator.
+ */
+int sim_init(const struct sim_options *options)
+{
+    l_options = *options;
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    sim_iap_init(l_options.eeprom_file);
+    if (sim_uart_open() < 0) {
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &l_start_time);
+    if (l_options.fan_hz != 0) {
+        l_fan_next_cycle = SYSCLK / l_options.fan_hz;
+    }
+    if (l_options.pwm_hz != 0 && l_options.pwm_duty != 0
+        && l_options.pwm_duty != 100) {
+        PWM_INPUT        = 0;
+        l_pwm_next_cycle = SYSCLK / l_options.pwm_hz;
+    } else {
+        PWM_INPUT = l_options.pwm_duty == 100 ? 1 : 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       Get virtual time.
+ */
+uint64_t sim_cycles()
+{
+    return l_cycles;
+}
+
+/**
+ * @brief       Get cycles of a count of Timer0.
+ *
+ * @return      Cycles.
+ */
+static uint32_t timer0_prescaler()
+{
+    return (AUXR & 0x80) ? 1 : 12;
+}
+
+/**
+ * @brief       Get the cycle of next Timer0 overflow.
+ *
+ * @return      Cycle of next overflow, UINT64_MAX if stopped.
+ */
+static uint64_t timer0_next_event()
+{
+    // Timer0 starts with the value written when stopped, 16-bit auto-reload.
+    if (! (TCON & 0x10)) {
+        l_timer0_running = false;
+        return UINT64_MAX;
+    }
+    if (! l_timer0_running) {
+        l_timer0_running = true;
+        l_timer0_reload  = ((uint32_t)TH0 << 8) | TL0;
+        l_timer0_count   = l_timer0_reload;
+        l_timer0_cycles  = l_cycles;
+    }
+
+    return l_timer0_cycles
+           + (uint64_t)(0x10000 - l_timer0_count) * timer0_prescaler();
+}
+
+/**
+ * @brief       Run Timer0 to current cycle.
+ */
+static void timer0_update()
+{
+    if (! l_timer0_running) {
+        return;
+    }
+
+    uint32_t prescaler = timer0_prescaler();
+    uint64_t counts    = (l_cycles - l_timer0_cycles) / prescaler;
+    l_timer0_cycles += counts * prescaler;
+    while (counts > 0) {
+        uint32_t left = 0x10000 - l_timer0_count;
+        if (counts < left) {
+            l_timer0_count += (uint32_t)counts;
+            break;
+        }
+        counts -= left;
+        l_timer0_count = l_timer0_reload;
+        TCON |= 0x20;
+    }
+
+    // The counter is readable by firmware.
+    TL0 = (uint8_t)(l_timer0_count & 0xFF);
+    TH0 = (uint8_t)(l_timer0_count >> 8);
+}
+
+/**
+ * @brief       Get cycles of a count of PCA.
+ *
+ * @return      Cycles, 0 if the clock source is not simulated.
+ */
+static uint32_t pca_prescaler()
+{
+    static const uint8_t prescalers[] = {12, 2, 0, 0, 1, 4, 6, 8};
+    return prescalers[(CMOD >> 1) & 0x07];
+}
+
+/**
+ * @brief       Get the counts until module 1 matches.
+ *
+ * @return      Counts, UINT32_MAX if the match is disabled.
+ */
+static uint32_t pca_counts_to_match()
+{
+    if ((CCAPM1 & 0x48) != 0x48) {
+        return UINT32_MAX;
+    }
+
+    uint32_t compare = ((uint32_t)CCAP1H << 8) | CCAP1L;
+    return ((compare - l_pca_count - 1) & 0xFFFF) + 1;
+}
+
+/**
+ * @brief       Get the cycle of next PCA overflow.
+ *
+ * @return      Cycle of next overflow, UINT64_MAX if stopped.
+ */
+static uint64_t pca_next_event()
+{
+    // PCA starts with the value written when stopped.
+    if (! (CCON & 0x40) || pca_prescaler() == 0) {
+        l_pca_running = false;
+        return UINT64_MAX;
+    }
+    if (! l_pca_running) {
+        l_pca_running = true;
+        l_pca_count   = ((uint32_t)CH << 8) | CL;
+        l_pca_cycles  = l_cycles;
+    }
+
+    // Overflow or match of module 1.
+    uint32_t counts = 0x10000 - l_pca_count;
+    uint32_t match  = pca_counts_to_match();
+    if (match < counts) {
+        counts = match;
+    }
+
+    return l_pca_cycles + (uint64_t)counts * pca_prescaler();
+}
+
+/**
+ * @brief       Run PCA to current cycle.
+ */
+static void pca_update()
+{
+    if (! l_pca_running) {
+        return;
+    }
+
+    uint32_t prescaler = pca_prescaler();
+    uint64_t counts    = (l_cycles - l_pca_cycles) / prescaler;
+    l_pca_cycles += counts * prescaler;
+
+    // Module 1 matches, toggling speed output.
+    if (counts > 0 && counts >= pca_counts_to_match()) {
+        CCON |= 0x02;
+        if (CCAPM1 & 0x04) {
+            SPEED_OUTPUT = ! SPEED_OUTPUT;
+        }
+    }
+
+    while (counts > 0) {
+        uint32_t left = 0x10000 - l_pca_count;
+        if (counts < left) {
+            l_pca_count += (uint32_t)counts;
+            break;
+        }
+        counts -= left;
+        l_pca_count = 0;
+        CCON |= 0x80;
+    }
+
+    // The counter is readable by firmware.
+    CL = (uint8_t)(l_pca_count & 0xFF);
+    CH = (uint8_t)(l_pca_count >> 8);
+}
+
+/**
+ * @brief       Toggle PWM input, the edge is captured by PCA module 0.
+ */
+static void pwm_edge()
+{
+    uint64_t period = SYSCLK / l_options.pwm_hz;
+    uint64_t high   = period * l_options.pwm_duty / 100;
+
+    PWM_INPUT = ! PWM_INPUT;
+    l_pwm_next_cycle += PWM_INPUT ? high : period - high;
+
+    if ((PWM_INPUT && (CCAPM0 & 0x20)) || (! PWM_INPUT && (CCAPM0 & 0x10))) {
+        CCAP0L = CL;
+        CCAP0H = CH;
+        CCON |= 0x01;
+    }
+}
+
+/**
+ * @brief       Call the ISRs of the interrupts requested.
+ */
+static void dispatch_interrupts()
+{
+    if (! (IE & 0x80)) {
+        return;
+    }
+
+    // Timer0, TF0 is cleared by the ISR.
+    if ((TCON & 0x20) && (IE & 0x02)) {
+        timer0_isr();
+    }
+
+    // INT3.
+    if (l_fan_next_cycle != 0 && l_cycles >= l_fan_next_cycle) {
+        l_fan_next_cycle += SYSCLK / l_options.fan_hz;
+        if (INTCLKO & 0x20) {
+            int1_isr();
+        }
+    }
+
+    // PCA overflow, capture and match, CF, CCF0 and CCF1 are cleared by the
+    // ISR.
+    if (((CCON & 0x80) && (CMOD & 0x01)) || ((CCON & 0x01) && (CCAPM0 & 0x01))
+        || ((CCON & 0x02) && (CCAPM1 & 0x01))) {
+        pca_isr();
+    }
+
+    // UART, RI and TI are cleared by the ISR.
+    if ((SCON & 0x03) && (IE & 0x10)) {
+        serial_isr();
+    }
+}
+
+/**
+ * @brief       Sleep while the virtual clock is ahead of the wall clock.
+ */
+static void pace()
+{
+    if (l_options.speed <= 0) {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t wall_ns = (int64_t)(now.tv_sec - l_start_time.tv_sec) * 1000000000
+                      + (now.tv_nsec - l_start_time.tv_nsec);
+    int64_t virtual_ns
+        = (int64_t)((double)l_cycles * 1e9 / SYSCLK / l_options.speed);
+    int64_t ahead = virtual_ns - wall_ns;
+    if (ahead >= MIN_SLEEP_NS) {
+        struct timespec duration = {(time_t)(ahead / 1000000000),
+                                    (long)(ahead % 1000000000)};
+        nanosleep(&duration, NULL);
+    }
+}
+
+/**
+ * @brief       Run the virtual clock to next event and call the ISRs.
+ */
+void sim_step()
+{
+    if (l_stop) {
+        exit(0);
+    }
+
+    // Find next event.
+    uint64_t next = l_cycles + MAX_STEP_CYCLES;
+    uint64_t event = timer0_next_event();
+    if (event < next) {
+        next = event;
+    }
+    event = pca_next_event();
+    if (event < next) {
+        next = event;
+    }
+    event = sim_uart_next_event(l_cycles);
+    if (event < next) {
+        next = event;
+    }
+    if (l_fan_next_cycle != 0 && l_fan_next_cycle < next) {
+        next = l_fan_next_cycle;
+    }
+    if (l_pwm_next_cycle != 0 && l_pwm_next_cycle < next) {
+        next = l_pwm_next_cycle;
+    }
+    if (next <= l_cycles) {
+        next = l_cycles + 1;
+    }
+
+    // Run.
+    l_cycles = next;
+    pace();
+    timer0_update();
+    pca_update();
+    if (l_pwm_next_cycle != 0 && l_cycles >= l_pwm_next_cycle) {
+        pwm_edge();
+    }
+    sim_uart_update(l_cycles);
+    dispatch_interrupts();
+}
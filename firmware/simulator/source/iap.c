@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <platform.h>
+#include <simulator.h>
+
+static uint8_t     l_eeprom[EEPROM_SIZE]; ///< Eeprom.
+static const char *l_file = NULL;         ///< File to keep eeprom.
+
+/**
+ * @brief       Load eeprom.
+ */
+void sim_iap_init(const char *file)
+{
+    memset(l_eeprom, 0xFF, sizeof(l_eeprom));
+    l_file = file;
+    if (l_file == NULL) {
+        return;
+    }
+
+    FILE *fp = fopen(l_file, "rb");
+    if (fp != NULL) {
+        if (fread(l_eeprom, 1, sizeof(l_eeprom), fp) != sizeof(l_eeprom)) {
+            memset(l_eeprom, 0xFF, sizeof(l_eeprom));
+        }
+        fclose(fp);
+    }
+}
+
+/**
+ * @brief       Save eeprom.
+ */
+static void save()
+{
+    if (l_file == NULL) {
+        return;
+    }
+
+    FILE *fp = fopen(l_file, "wb");
+    if (fp == NULL) {
+        perror("Failed to save eeprom");
+        return;
+    }
+    fwrite(l_eeprom, 1, sizeof(l_eeprom), fp);
+    fclose(fp);
+}
+
+/**
+ * @brief       Run IAP command, called when firmware triggers IAP.
+ */
+void sim_iap_trigger()
+{
+    uint16_t addr = ((uint16_t)IAP_ADDRH << 8) | IAP_ADDRL;
+    if (! (IAP_CONTR & 0x80) || addr >= EEPROM_SIZE) {
+        IAP_CONTR |= 0x10;
+        return;
+    }
+
+    switch (IAP_CMD & 0x03) {
+        case 0x01:
+            // Read.
+            IAP_DATA = l_eeprom[addr];
+            break;
+
+        case 0x02:
+            // Program, bits can only be cleared.
+            l_eeprom[addr] &= IAP_DATA;
+            save();
+            break;
+
+        case 0x03:
+            // Erase page.
+            memset(l_eeprom + (addr & ~(EEPROM_PAGE_SIZE - 1)), 0xFF,
+                   EEPROM_PAGE_SIZE);
+            save();
+            break;
+
+        default:
+            // Standby.
+            break;
+    }
+}
@@ -0,0 +1,82 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <simulator.h>
+
+/**
+ * @brief       Print usage.
+ *
+ * @param[in]   name        Name of the executable.
+ */
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "Run firmware natively, the UART is a pseudo-terminal.\n"
+            "\n"
+            "  -s, --speed FACTOR   Virtual time / wall time, 0 for no limit,\n"
+            "                       1 by default.\n"
+            "  -f, --fan-hz HZ      Pulses per second on speed input.\n"
+            "  -p, --pwm-hz HZ      Frequency of PWM input.\n"
+            "  -d, --pwm-duty DUTY  Duty cycle of PWM input, 0-100.\n"
+            "  -e, --eeprom FILE    File to keep eeprom.\n"
+            "  -h, --help           Print this message.\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    struct sim_options options = {1.0, 0, 0, 0, NULL};
+
+    static const struct option long_options[]
+        = {{"speed", required_argument, NULL, 's'},
+           {"fan-hz", required_argument, NULL, 'f'},
+           {"pwm-hz", required_argument, NULL, 'p'},
+           {"pwm-duty", required_argument, NULL, 'd'},
+           {"eeprom", required_argument, NULL, 'e'},
+           {"help", no_argument, NULL, 'h'},
+           {NULL, 0, NULL, 0}};
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:f:p:d:e:h", long_options, NULL))
+           != -1) {
+        switch (opt) {
+            case 's':
+                options.speed = atof(optarg);
+                break;
+
+            case 'f':
+                options.fan_hz = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+
+            case 'p':
+                options.pwm_hz = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+
+            case 'd':
+                options.pwm_duty = (uint8_t)strtoul(optarg, NULL, 10);
+                if (options.pwm_duty > 100) {
+                    options.pwm_duty = 100;
+                }
+                break;
+
+            case 'e':
+                options.eeprom_file = optarg;
+                break;
+
+            case 'h':
+                usage(argv[0]);
+                return 0;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (sim_init(&options) < 0) {
+        return 1;
+    }
+
+    return firmware_main();
+}
@@ -0,0 +1,4 @@
+// SFRs declared in platform.h are defined here.
+#define SIMULATOR_DEFINE_SFR
+
+#include <platform.h>
@@ -0,0 +1,214 @@
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <platform.h>
+#include <simulator.h>
+
+/// Size of the buffer of bytes read from the pseudo-terminal.
+#define RX_BUFFER_SIZE 4096
+
+static int l_master_fd = -1; ///< Master side, the UART of firmware.
+static int l_slave_fd  = -1; ///< Slave side, kept open for the host.
+
+static uint8_t  l_rx_buffer[RX_BUFFER_SIZE]; ///< Bytes not received yet.
+static size_t   l_rx_begin      = 0;         ///< First byte in buffer.
+static size_t   l_rx_end        = 0;         ///< End of bytes in buffer.
+static uint64_t l_rx_next_cycle = 0;         ///< Cycle of next byte received.
+
+static bool     l_tx_busy  = false; ///< Sending a byte.
+static uint8_t  l_tx_byte  = 0;     ///< Byte being sent.
+static uint64_t l_tx_cycle = 0;     ///< Cycle when the byte is sent.
+
+/**
+ * @brief       Get baud rate of firmware.
+ *
+ * @return      Baud rate, Timer1 in 8-bit auto-reload mode, SMOD = 0.
+ */
+static uint32_t firmware_baud_rate()
+{
+    uint32_t divisor = (uint32_t)(256 - TH1) * 32;
+    if (! (AUXR & 0x40)) {
+        divisor *= 12;
+    }
+
+    return SYSCLK / divisor;
+}
+
+/**
+ * @brief       Get baud rate set by the host on the pseudo-terminal.
+ *
+ * @return      Baud rate, 0 if unknown.
+ */
+static uint32_t host_baud_rate()
+{
+    struct termios options;
+    if (tcgetattr(l_slave_fd, &options) < 0) {
+        return 0;
+    }
+
+    switch (cfgetospeed(&options)) {
+        case B9600:
+            return 9600;
+
+        case B19200:
+            return 19200;
+
+        case B38400:
+            return 38400;
+
+        case B57600:
+            return 57600;
+
+        case B115200:
+            return 115200;
+
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief       Check if the baud rates of the host and firmware match, bytes
+ *              are lost if not.
+ *
+ * @return      \c true if matched, otherwise returns \c false.
+ */
+static bool baud_rate_matched()
+{
+    uint32_t host = host_baud_rate();
+
+    // The reload value gives the closest rate, allow 2% error.
+    uint32_t firmware = firmware_baud_rate();
+    return host == 0
+           || (firmware * 50 >= host * 49 && firmware * 50 <= host * 51);
+}
+
+/**
+ * @brief       Get cycles to transfer a byte.
+ *
+ * @return      Cycles of 10 bits.
+ */
+static uint64_t byte_cycles()
+{
+    return (uint64_t)SYSCLK * 10 / firmware_baud_rate();
+}
+
+/**
+ * @brief       Open the pseudo-terminal of simulated UART.
+ */
+int sim_uart_open()
+{
+    l_master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (l_master_fd < 0 || grantpt(l_master_fd) < 0
+        || unlockpt(l_master_fd) < 0) {
+        perror("Failed to open pseudo-terminal");
+        return -1;
+    }
+    fcntl(l_master_fd, F_SETFL, fcntl(l_master_fd, F_GETFL) | O_NONBLOCK);
+
+    // Keep the slave side open so the master side does not fail when the
+    // host closes the port.
+    const char *name = ptsname(l_master_fd);
+    l_slave_fd       = open(name, O_RDWR | O_NOCTTY);
+    if (l_slave_fd < 0) {
+        perror("Failed to open pseudo-terminal");
+        return -1;
+    }
+    struct termios options;
+    tcgetattr(l_slave_fd, &options);
+    cfmakeraw(&options);
+    cfsetispeed(&options, B9600);
+    cfsetospeed(&options, B9600);
+    tcsetattr(l_slave_fd, TCSANOW, &options);
+
+    // The host opens "/dev/<port>".
+    printf("UART : %s\n", name);
+    fflush(stdout);
+
+    return 0;
+}
+
+/**
+ * @brief       Start sending byte, called when firmware writes SBUF.
+ */
+void sim_uart_send(uint8_t byte)
+{
+    l_tx_busy  = true;
+    l_tx_byte  = byte;
+    l_tx_cycle = sim_cycles() + byte_cycles();
+}
+
+/**
+ * @brief       Get the cycle of next UART event.
+ */
+uint64_t sim_uart_next_event(uint64_t now)
+{
+    uint64_t next = UINT64_MAX;
+    if (l_tx_busy) {
+        next = l_tx_cycle;
+    }
+    if (l_rx_begin != l_rx_end) {
+        uint64_t rx = l_rx_next_cycle > now ? l_rx_next_cycle : now;
+        if (rx < next) {
+            next = rx;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * @brief       Run UART to cycle.
+ */
+void sim_uart_update(uint64_t now)
+{
+    // Send.
+    if (l_tx_busy && now >= l_tx_cycle) {
+        l_tx_busy = false;
+        if (baud_rate_matched()) {
+            // No flow control, the byte is lost if the host does not read.
+            if (write(l_master_fd, &l_tx_byte, 1) < 0 && errno != EAGAIN) {
+                perror("Failed to write pseudo-terminal");
+            }
+        }
+        SCON |= 0x02;
+    }
+
+    // Read bytes from the host.
+    if (l_rx_begin == l_rx_end) {
+        l_rx_begin   = 0;
+        l_rx_end     = 0;
+        ssize_t size = read(l_master_fd, l_rx_buffer, RX_BUFFER_SIZE);
+        if (size > 0) {
+            l_rx_end = (size_t)size;
+            if (l_rx_next_cycle < now + byte_cycles()) {
+                l_rx_next_cycle = now + byte_cycles();
+            }
+        }
+    }
+
+    // Receive.
+    if (l_rx_begin != l_rx_end && now >= l_rx_next_cycle) {
+        uint8_t byte = l_rx_buffer[l_rx_begin++];
+        l_rx_next_cycle += byte_cycles();
+        if (l_rx_next_cycle < now) {
+            l_rx_next_cycle = now;
+        }
+
+        if (! baud_rate_matched()) {
+            // Framing error, the byte is lost.
+        } else if (SCON & 0x01) {
+            fprintf(stderr, "UART overrun, byte 0x%02X lost.\n", byte);
+        } else {
+            SBUF = byte;
+            SCON |= 0x01;
+        }
+    }
+}
@@ -2,44 +2,136 @@
 
 #include <clock_io.h>
 
-#define TICK_US               17
-#define SAMPLING_TTICKS       29411
-#define SAMPLING_MICROSECONDS ((uint32_t)SAMPLING_TTICKS * TICK_US)
+#define TICK_US 1000
+
+// Edges are counted in sub-windows of SPEED_SUB_WINDOW_TICKS, the speed is
+// the running sum of the last l_speed_window_size sub-windows.
+#define SPEED_SUB_WINDOW_TICKS ((uint8_t)(SPEED_SUB_WINDOW_MS * 1000 / TICK_US))
+#define SPEED_SUB_WINDOW_MAX   (SPEED_WINDOW_MAX_MS / SPEED_SUB_WINDOW_MS)
+
+// Timer0 runs 1T with 16-bit auto-reload, 33178 cycles a tick.
+#define TIMER0_RELOAD 0x7E66
+#define TIMER0_CYCLES ((uint16_t)(0x10000 - TIMER0_RELOAD))
+
+// Cycles to μs, (cycles * TIMER0_US_FACTOR) >> 16 < TICK_US.
+#define TIMER0_US_FACTOR 1975
+
+// No edge in this time, input speed is 0.
+#define SPEED_PERIOD_TIMEOUT_US ((uint32_t)1000000)
+
+// Input PWM is captured every PWM_CAPTURE_INTERVAL_US, no edge in this time
+// means the duty cycle is 0 or 100.
+#define PWM_CAPTURE_INTERVAL_US ((uint32_t)20000)
+
+// States of input PWM capture.
+#define PWM_CAPTURE_IDLE    0x00 ///< Not capturing.
+#define PWM_CAPTURE_RISING  0x01 ///< Waiting for the first rising edge.
+#define PWM_CAPTURE_FALLING 0x02 ///< Waiting for the falling edge.
+#define PWM_CAPTURE_PERIOD  0x03 ///< Waiting for the second rising edge.
+#define PWM_CAPTURE_DONE    0x04 ///< Captured.
+
+// CCAPM0 capturing both edges with interrupt, armed once for a capture so no
+// edge is lost while the ISR re-arms, the edge is told by the level of pin.
+#define PCA_CAPTURE_BOTH 0x31
+
+// CCAPM2 of 8-bit PWM output, SYSCLK / 6 / 256 = 21.6kHz.
+#define PCA_PWM_OUTPUT 0x42
+
+// CCAPM1 of speed output, match with interrupt, toggling the pin or not.
+#define PCA_SPEED_OUTPUT_TOGGLE 0x4D
+#define PCA_SPEED_OUTPUT_WAIT   0x49
+
+// Speed output runs on half periods in 1/16 PCA counts, from speed in 1/16
+// Hz, PCA_CLOCK / (2 * speed / 16) * 16.
+#define SPEED_OUTPUT_HALF_PERIOD(speed) ((uint32_t)PCA_CLOCK * 128 / (speed))
+
+// Min half period(1/16 PCA counts), the PCA ISR must reprogram the compare
+// value in this time, max 2.7kHz.
+#define SPEED_OUTPUT_MIN_HALF_PERIOD ((uint32_t)1024 << 4)
+
+// Max step of the compare value(1/16 PCA counts), longer half periods are
+// split into steps without toggling.
+#define SPEED_OUTPUT_MAX_STEP ((uint32_t)0x8000 << 4)
 
 #define FLAG_SPEED_COUNT_UPDATED 0x01
-#define FLAG_PWM_COUNT_UPDATED   0x02
 
-static __data uint32_t l_boot_time = 0;                    ///< Boot time.
-static __data uint8_t  l_mode      = FIRMWARE_MODE_NORMAL; ///< Firmware mode.
+static volatile __data uint32_t l_boot_time = 0; ///< Boot time of last tick.
+static __data uint8_t l_mode = FIRMWARE_MODE_NORMAL; ///< Firmware mode.
+
+/// Generation of the data written by Timer0 ISR, increased by each tick.
+/// Readers retry until the generation is unchanged across the read instead
+/// of masking Timer0.
+static volatile __data uint8_t l_timer0_generation = 0;
 
 static __data uint8_t time0_flags = 0; ///< Timer 0 flags.
 
+/// PCA overflows, the high word of PCA time.
+static volatile __data uint16_t l_pca_overflows = 0;
+
 // Input Speed.
-static __data uint16_t l_speed_current_sampling_tick
-    = 0; ///< Curent sampling tick.
-static __data uint16_t l_speed_current_sampling_count
-    = 0;                                        ///< Sampling input speed count.
-static __data uint16_t l_speed_input_count = 0; ///< Input speed count.
-static __data uint16_t l_speed_input_hz    = 0; ///< Input speed hz.
+static __data uint8_t l_speed_sub_window_tick
+    = 0; ///< Ticks of current sub-window.
+static __data uint16_t l_speed_sub_window_count
+    = 0; ///< Edges in current sub-window.
+static volatile __data uint16_t l_speed_input_count
+    = 0; ///< Edges in last sub-window.
+static __data uint16_t l_speed_input_hz = 0; ///< Input speed hz.
+static __data uint8_t  l_speed_method
+    = SPEED_METHOD_PERIOD; ///< Method to measure speed.
+
+// Input speed, sliding window of edges counted.
+static __xdata uint16_t
+    l_speed_window[SPEED_SUB_WINDOW_MAX]; ///< Edges of each sub-window.
+static __data uint8_t l_speed_window_size
+    = SPEED_WINDOW_DEFAULT_MS / SPEED_SUB_WINDOW_MS; ///< Sub-windows.
+static __data uint8_t l_speed_window_index  = 0; ///< Next sub-window.
+static __data uint8_t l_speed_window_filled = 0; ///< Sub-windows counted.
+static __data uint32_t l_speed_window_sum   = 0; ///< Edges in the window.
+
+// Input speed, period between edges.
+static __data uint32_t l_speed_edge_time = 0; ///< PCA time of last edge.
+static __data bool     l_speed_edge_valid
+    = false; ///< l_speed_edge_time is valid.
+static volatile __data uint32_t l_speed_period
+    = 0; ///< PCA counts between last two edges.
+static volatile __data uint8_t l_speed_period_generation
+    = 0; ///< Increased by each period measured.
+static __data uint8_t l_speed_period_read_generation
+    = 0; ///< Generation of the period last read.
+static __data uint32_t l_speed_period_read_time
+    = 0; ///< Boot time when the period was last read.
 
 // Input PWM.
-#define PWM_SAMPLING_COUNT_MAX ((uint8_t)100)
-static __data uint8_t l_input_sampling_pwm_count
-    = 0; ///< Sampling input pwm count.
-static __data uint8_t l_input_sampling_pwm_high_level_count
-    = 0; ///< Sampling input pwm high level count.
-static __data uint8_t l_input_pwm_high_level_count = 0; ///< Input pwm count.
-
-/*
-static __data uint16_t l_output_change_tick = 0; ///< Input speed count.
-static __data uint16_t l_current_input_pwm_high_level_count
-    = 0; ///< Curent input pwm high-level ticks.
-
-static __data uint16_t l_output_speed_interval
-    = 0xFF; ///< Inverval to output low-level on speed output pin.
-static __data uint16_t l_output_speed_ticks_count
-    = 0; ///< Count to output low-level on speed output pin.
-*/
+static volatile __data uint8_t l_pwm_capture_state
+    = PWM_CAPTURE_IDLE; ///< State of capture.
+static __data uint32_t l_pwm_capture_begin_time
+    = 0; ///< Boot time when the capture began.
+static __data uint32_t l_pwm_rising_time = 0; ///< PCA time of rising edge.
+static __data uint32_t l_pwm_high_counts = 0; ///< PCA counts of high level.
+static __data uint32_t l_pwm_period_counts = 0; ///< PCA counts of a period.
+static __data uint8_t  l_input_pwm_duty_cycle = 0; ///< Input duty cycle.
+static __data uint16_t l_input_pwm_hz = 0; ///< Input PWM frequency.
+
+// Output PWM.
+static __data uint8_t l_output_pwm_duty_cycle = 100; ///< Output duty cycle.
+
+// Output speed, the pin is toggled by PCA module 1 on match, the PCA ISR
+// only moves the compare value before next match, so the edges have no
+// jitter from other ISRs.
+static __xdata uint32_t l_output_speed = 0; ///< Output speed(1/16 Hz).
+static __data bool      l_output_speed_changed
+    = false; ///< l_output_speed not applied yet.
+static __data uint32_t l_speed_output_phase
+    = 0; ///< Next compare value(1/16 PCA counts).
+static __data uint32_t l_speed_output_left
+    = 0; ///< Left of current half period(1/16 PCA counts).
+static __data uint32_t l_speed_output_half_period
+    = 0; ///< Half period(1/16 PCA counts).
+static __xdata uint32_t l_speed_output_next_half_period
+    = 0; ///< Half period posted to PCA ISR.
+static volatile __data bool l_speed_output_posted
+    = false; ///< l_speed_output_next_half_period not taken by PCA ISR yet.
+
 /**
  * @brief       Initialize clock.
  */
@@ -48,8 +140,23 @@ void clock_init()
     TCON &= 0xEF;
     AUXR |= 0x80;
     TMOD &= 0xF0;
-    TL0 = 0xCC;
-    TH0 = 0xFD;
+    TL0 = (uint8_t)(TIMER0_RELOAD & 0xFF);
+    TH0 = (uint8_t)(TIMER0_RELOAD >> 8);
+
+    // PCA counts SYSCLK / 6 with overflow interrupt.
+    CCON = 0;
+    CMOD = 0x0D;
+    CL   = 0;
+    CH   = 0;
+
+    // Output PWM, full speed until set.
+    PCA_PWM2 = 0;
+    CCAP2L   = 0;
+    CCAP2H   = 0;
+    CCAPM2   = PCA_PWM_OUTPUT;
+
+    // Speed output, stopped until set.
+    CCAPM1 = 0;
 }
 
 /**
@@ -59,17 +166,67 @@ void enable_clock()
 {
     IE |= 0x02;
     TCON |= 0x10;
+    CCON |= 0x40;
 }
 
 /**
  * @brief       Get boot time(μs).
+ *
+ * The time of last tick is extended with the counter of Timer0.
  */
 uint32_t boot_time()
 {
-    IE &= 0xFD;
-    __idata uint32_t ret = l_boot_time;
-    IE |= 0x02;
-    return ret;
+    uint8_t          generation;
+    uint8_t          high;
+    uint8_t          low;
+    uint16_t         cycles;
+    __idata uint32_t ret;
+
+    do {
+        generation = l_timer0_generation;
+        ret        = l_boot_time;
+
+        // Read counter, TL0 may carry into TH0 between the reads.
+        do {
+            high = TH0;
+            low  = TL0;
+        } while (high != TH0);
+        cycles = (((uint16_t)high << 8) | low) - TIMER0_RELOAD;
+
+        // Overflow not served yet.
+        if ((TCON & 0x20) && cycles < TIMER0_CYCLES / 2) {
+            ret += TICK_US;
+        }
+    } while (generation != l_timer0_generation);
+
+    return ret + (uint16_t)(((uint32_t)cycles * TIMER0_US_FACTOR) >> 16);
+}
+
+/**
+ * @brief       Get PCA time.
+ *
+ * Called only in ISRs which PCA ISR can not preempt.
+ *
+ * @return      PCA counts since the clock was enabled.
+ */
+static uint32_t pca_time()
+{
+    uint8_t  high;
+    uint8_t  low;
+    uint16_t overflows = l_pca_overflows;
+
+    // Read counter, CL may carry into CH between the reads.
+    do {
+        high = CH;
+        low  = CL;
+    } while (high != CH);
+
+    // Overflow not served yet.
+    if ((CCON & 0x80) && high < 0x80) {
+        ++overflows;
+    }
+
+    return ((uint32_t)overflows << 16) | ((uint16_t)high << 8) | low;
 }
 
 /**
@@ -78,33 +235,162 @@ uint32_t boot_time()
 void timer0_isr() __interrupt INT_TIMER0
 {
     TCON &= 0xDF;
-    l_boot_time += 17;
-    ++l_speed_current_sampling_tick;
-    if (l_speed_current_sampling_tick >= SAMPLING_TTICKS) {
+    l_boot_time += TICK_US;
+    ++l_timer0_generation;
+    ++l_speed_sub_window_tick;
+    if (l_speed_sub_window_tick >= SPEED_SUB_WINDOW_TICKS) {
         // Input speed.
-        l_speed_input_count            = l_speed_current_sampling_count;
-        l_speed_current_sampling_count = 0;
-        l_speed_current_sampling_tick  = 0;
+        l_speed_input_count      = l_speed_sub_window_count;
+        l_speed_sub_window_count = 0;
+        l_speed_sub_window_tick  = 0;
         time0_flags |= FLAG_SPEED_COUNT_UPDATED;
     }
 }
 
+/**
+ * @brief       Apply output speed.
+ *
+ * A running output takes the new half period at next edge through
+ * l_speed_output_next_half_period, which is written only when PCA ISR has
+ * taken the last one, otherwise it is retried by next call.
+ */
+static void speed_output_second_stage()
+{
+    uint8_t  high;
+    uint8_t  low;
+    uint32_t half_period;
+
+    if (l_output_speed == 0) {
+        CCAPM1                 = 0;
+        l_output_speed_changed = false;
+        return;
+    }
+
+    half_period = SPEED_OUTPUT_HALF_PERIOD(l_output_speed);
+    if (half_period < SPEED_OUTPUT_MIN_HALF_PERIOD) {
+        half_period = SPEED_OUTPUT_MIN_HALF_PERIOD;
+    }
+
+    if (CCAPM1 != 0) {
+        // Running.
+        if (l_speed_output_posted) {
+            return;
+        }
+        l_speed_output_next_half_period = half_period;
+        l_speed_output_posted           = true;
+
+    } else {
+        // Stopped, PCA ISR does not touch the output, first edge after a
+        // min half period.
+        do {
+            high = CH;
+            low  = CL;
+        } while (high != CH);
+
+        l_speed_output_posted      = false;
+        l_speed_output_half_period = half_period;
+        l_speed_output_left        = 0;
+        l_speed_output_phase       = ((((uint32_t)high << 8) | low) << 4)
+                               + SPEED_OUTPUT_MIN_HALF_PERIOD;
+        CCON &= 0xFD;
+        CCAP1L = (uint8_t)(l_speed_output_phase >> 4);
+        CCAP1H = (uint8_t)(l_speed_output_phase >> 12);
+        CCAPM1 = PCA_SPEED_OUTPUT_TOGGLE;
+    }
+
+    l_output_speed_changed = false;
+}
+
 /**
  * @brief       Timer0 ISR second stage.
  */
 void timer0_isr_second_stage()
 {
-    // Update speed.
+    __idata uint32_t tmp;
+    uint8_t          generation;
+
+    // Update speed by counting, the oldest sub-window is replaced.
     if (time0_flags & FLAG_SPEED_COUNT_UPDATED) {
         time0_flags &= MASK(uint8_t, FLAG_SPEED_COUNT_UPDATED);
-        __idata uint32_t tmp = l_speed_input_count;
-        tmp                  = tmp * 1000000 / SAMPLING_MICROSECONDS;
-        l_speed_input_hz     = (uint16_t)tmp;
+        if (l_speed_method == SPEED_METHOD_COUNTING) {
+            do {
+                generation = l_timer0_generation;
+                tmp        = l_speed_input_count;
+            } while (generation != l_timer0_generation);
+
+            l_speed_window_sum -= l_speed_window[l_speed_window_index];
+            l_speed_window_sum += tmp;
+            l_speed_window[l_speed_window_index] = (uint16_t)tmp;
+            if (++l_speed_window_index >= l_speed_window_size) {
+                l_speed_window_index = 0;
+            }
+            if (l_speed_window_filled < l_speed_window_size) {
+                ++l_speed_window_filled;
+            }
+
+            l_speed_input_hz = (uint16_t)(
+                l_speed_window_sum * 1000
+                / ((uint16_t)l_speed_window_filled * SPEED_SUB_WINDOW_MS));
+        }
+    }
+
+    // Update speed by period.
+    if (l_speed_method == SPEED_METHOD_PERIOD) {
+        do {
+            generation = l_speed_period_generation;
+            tmp        = l_speed_period;
+        } while (generation != l_speed_period_generation);
+
+        if (generation != l_speed_period_read_generation) {
+            l_speed_period_read_generation = generation;
+            l_speed_period_read_time       = boot_time();
+            l_speed_input_hz = (uint16_t)((PCA_CLOCK + tmp / 2) / tmp);
+
+        } else if (l_speed_input_hz != 0
+                   && boot_time() - l_speed_period_read_time
+                          > SPEED_PERIOD_TIMEOUT_US) {
+            // Stopped, the period from the next edge is meaningless.
+            l_speed_edge_valid = false;
+            l_speed_input_hz   = 0;
+        }
+    }
+
+    // Update speed output.
+    if (l_output_speed_changed && l_mode != FIRMWARE_MODE_TEST) {
+        speed_output_second_stage();
     }
 
-    // Update pwm.
-    if (time0_flags & FLAG_PWM_COUNT_UPDATED) {
-        time0_flags &= MASK(uint8_t, FLAG_PWM_COUNT_UPDATED);
+    // Update pwm, the counts are not touched by PCA ISR until next capture.
+    switch (l_pwm_capture_state) {
+        case PWM_CAPTURE_DONE:
+            tmp = (l_pwm_high_counts * 100 + l_pwm_period_counts / 2)
+                  / l_pwm_period_counts;
+            l_input_pwm_duty_cycle = tmp > 100 ? 100 : (uint8_t)tmp;
+            l_input_pwm_hz         = (uint16_t)(
+                (PCA_CLOCK + l_pwm_period_counts / 2) / l_pwm_period_counts);
+            l_pwm_capture_state = PWM_CAPTURE_IDLE;
+            break;
+
+        case PWM_CAPTURE_IDLE:
+            tmp = boot_time();
+            if (tmp - l_pwm_capture_begin_time >= PWM_CAPTURE_INTERVAL_US) {
+                l_pwm_capture_begin_time = tmp;
+                l_pwm_capture_state      = PWM_CAPTURE_RISING;
+                CCON &= 0xFE;
+                CCAPM0 = PCA_CAPTURE_BOTH;
+            }
+            break;
+
+        default:
+            if (boot_time() - l_pwm_capture_begin_time
+                >= PWM_CAPTURE_INTERVAL_US) {
+                // No edge, constant level.
+                CCAPM0                 = 0;
+                l_pwm_capture_state    = PWM_CAPTURE_IDLE;
+                l_input_pwm_duty_cycle = PWM_INPUT ? 100 : 0;
+                l_input_pwm_hz         = 0;
+            }
+            break;
     }
 }
 
@@ -152,6 +438,14 @@ uint8_t current_mode()
  */
 void set_current_mode(uint8_t mode)
 {
+    // PWM_OUTPUT and SPEED_OUTPUT are written by WritePort in test mode.
+    CCAPM2 = mode == FIRMWARE_MODE_TEST ? 0 : PCA_PWM_OUTPUT;
+    if (mode == FIRMWARE_MODE_TEST) {
+        CCAPM1 = 0;
+    } else {
+        // Restarted by next second stage if stopped.
+        l_output_speed_changed = true;
+    }
     l_mode = mode;
 }
 
@@ -163,10 +457,220 @@ uint16_t input_speed()
     return l_speed_input_hz;
 }
 
+/**
+ * @brief       Clear the sliding window of edges counted.
+ */
+static void speed_window_reset()
+{
+    for (uint8_t i = 0; i < SPEED_SUB_WINDOW_MAX; ++i) {
+        l_speed_window[i] = 0;
+    }
+    l_speed_window_index  = 0;
+    l_speed_window_filled = 0;
+    l_speed_window_sum    = 0;
+}
+
+/**
+ * @brief       Set the method to measure input speed.
+ */
+void set_speed_method(uint8_t method)
+{
+    l_speed_edge_valid = false;
+    l_speed_method     = method;
+    speed_window_reset();
+}
+
+/**
+ * @brief       Set the window to count edges.
+ *
+ * The speed is estimated from the sub-windows counted until the window is
+ * filled.
+ */
+void set_speed_window(uint8_t sub_windows)
+{
+    l_speed_window_size = sub_windows;
+    speed_window_reset();
+}
+
+/**
+ * @brief       Get input pwm.
+ */
+uint8_t input_pwm()
+{
+    return l_input_pwm_duty_cycle;
+}
+
+/**
+ * @brief       Get input pwm frequency.
+ */
+uint16_t input_pwm_frequency()
+{
+    return l_input_pwm_hz;
+}
+
+/**
+ * @brief       Set output pwm.
+ *
+ * The output is low while CL < {EPC2L, CCAP2L}, both are reloaded from
+ * {EPC2H, CCAP2H} on PCA overflow, so the duty cycle changes at the end of
+ * a period without glitch. 0% sets EPC2H to make the compare value 0x1FF.
+ */
+void set_output_pwm(uint8_t duty_cycle)
+{
+    if (duty_cycle > 100) {
+        duty_cycle = 100;
+    }
+    l_output_pwm_duty_cycle = duty_cycle;
+
+    if (duty_cycle == 0) {
+        PCA_PWM2 |= 0x02;
+        CCAP2H = 0xFF;
+    } else {
+        PCA_PWM2 &= 0xFD;
+        // duty_cycle * 2.56, no division.
+        CCAP2H = (uint8_t)(256 - (((uint16_t)duty_cycle * 655 + 128) >> 8));
+    }
+}
+
+/**
+ * @brief       Get output pwm.
+ */
+uint8_t output_pwm()
+{
+    return l_output_pwm_duty_cycle;
+}
+
+/**
+ * @brief       Set output speed.
+ */
+void set_output_speed(uint32_t speed)
+{
+    if (speed != l_output_speed) {
+        l_output_speed         = speed;
+        l_output_speed_changed = true;
+    }
+}
+
+/**
+ * @brief       Get output speed.
+ */
+uint32_t output_speed()
+{
+    return l_output_speed;
+}
+
 /**
  * @brief       INT1 ISR.
  */
 void int1_isr(void) __interrupt INT_INT3
 {
-    ++l_speed_current_sampling_count;
+    ++l_speed_sub_window_count;
+
+    if (l_speed_method == SPEED_METHOD_PERIOD) {
+        __data uint32_t now = pca_time();
+        if (l_speed_edge_valid) {
+            l_speed_period = now - l_speed_edge_time;
+            ++l_speed_period_generation;
+        }
+        l_speed_edge_time  = now;
+        l_speed_edge_valid = true;
+    }
+}
+
+/**
+ * @brief       PCA ISR.
+ */
+void pca_isr(void) __interrupt INT_PCA
+{
+    // Input PWM edge, handled before the overflow which may follow it.
+    if (CCON & 0x01) {
+        CCON &= 0xFE;
+
+        uint8_t  high      = CCAP0H;
+        uint16_t overflows = l_pca_overflows;
+        if ((CCON & 0x80) && high < 0x80) {
+            ++overflows;
+        }
+        __data uint32_t time = ((uint32_t)overflows << 16)
+                               | ((uint16_t)high << 8) | CCAP0L;
+
+        // Sampled after the capture, if the pin has changed again the next
+        // edge is pending and resynchronizes the states.
+        __data bool rising = PWM_INPUT;
+
+        switch (l_pwm_capture_state) {
+            case PWM_CAPTURE_RISING:
+                if (rising) {
+                    l_pwm_rising_time   = time;
+                    l_pwm_capture_state = PWM_CAPTURE_FALLING;
+                }
+                break;
+
+            case PWM_CAPTURE_FALLING:
+                if (rising) {
+                    // Falling edge missed, restart from this one.
+                    l_pwm_rising_time = time;
+                } else {
+                    l_pwm_high_counts   = time - l_pwm_rising_time;
+                    l_pwm_capture_state = PWM_CAPTURE_PERIOD;
+                }
+                break;
+
+            case PWM_CAPTURE_PERIOD:
+                if (! rising) {
+                    // Rising edge missed.
+                    l_pwm_capture_state = PWM_CAPTURE_RISING;
+                } else if (l_pwm_high_counts
+                           >= time - l_pwm_rising_time) {
+                    // Edges mismatched, restart from this one.
+                    l_pwm_rising_time   = time;
+                    l_pwm_capture_state = PWM_CAPTURE_FALLING;
+                } else {
+                    l_pwm_period_counts = time - l_pwm_rising_time;
+                    CCAPM0              = 0;
+                    l_pwm_capture_state = PWM_CAPTURE_DONE;
+                }
+                break;
+
+            default:
+                CCAPM0 = 0;
+                break;
+        }
+    }
+
+    // Speed output matched, ignored if stopped.
+    if (CCON & 0x02) {
+        CCON &= 0xFD;
+
+        if (CCAPM1 != 0) {
+            if (l_speed_output_left == 0) {
+                // The pin has been toggled, begin next half period.
+                if (l_speed_output_posted) {
+                    l_speed_output_half_period
+                        = l_speed_output_next_half_period;
+                    l_speed_output_posted = false;
+                }
+                l_speed_output_left = l_speed_output_half_period;
+            }
+
+            if (l_speed_output_left > SPEED_OUTPUT_MAX_STEP) {
+                l_speed_output_phase += SPEED_OUTPUT_MAX_STEP;
+                l_speed_output_left -= SPEED_OUTPUT_MAX_STEP;
+                CCAP1L = (uint8_t)(l_speed_output_phase >> 4);
+                CCAP1H = (uint8_t)(l_speed_output_phase >> 12);
+                CCAPM1 = PCA_SPEED_OUTPUT_WAIT;
+            } else {
+                l_speed_output_phase += l_speed_output_left;
+                l_speed_output_left = 0;
+                CCAP1L = (uint8_t)(l_speed_output_phase >> 4);
+                CCAP1H = (uint8_t)(l_speed_output_phase >> 12);
+                CCAPM1 = PCA_SPEED_OUTPUT_TOGGLE;
+            }
+        }
+    }
+
+    if (CCON & 0x80) {
+        CCON &= 0x7F;
+        ++l_pca_overflows;
+    }
 }
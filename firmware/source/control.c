@@ -0,0 +1,141 @@
+#include <types.h>
+
+#include <clock_io.h>
+#include <control.h>
+#include <eeprom.h>
+
+#define PWM_STAGES      10 ///< Stages of pwmMap.
+#define PWM_STAGE_WIDTH 10 ///< Input duty cycle of a stage.
+#define SPEED_POINTS    10 ///< Points of speedMap.
+
+/// Input speed not mapped yet.
+#define SPEED_INVALID 0xFFFF
+
+/// Output duty cycle of each input duty cycle, expanded from pwmMap.
+static __xdata uint8_t l_pwm_lut[PWM_STAGES * PWM_STAGE_WIDTH + 1];
+
+// Segments of speedMap, output = dest + (input - source) * slope.
+static __xdata uint16_t l_speed_source[SPEED_POINTS]; ///< Source(Hz).
+static __xdata uint32_t l_speed_dest[SPEED_POINTS];   ///< Dest(1/256 Hz).
+static __xdata int32_t
+    l_speed_slope[SPEED_POINTS]; ///< Slope to next point(1/256).
+static __data uint16_t l_speed_input
+    = SPEED_INVALID; ///< Input speed last mapped.
+
+/**
+ * @brief       Initialize, the config has been loaded by eeprom_init().
+ */
+void control_init()
+{
+    control_load_config(eeprom_config());
+}
+
+/**
+ * @brief       Get output duty cycle of a stage of pwmMap.
+ */
+static uint8_t pwm_stage(const struct FirmwareConfig *config, uint8_t stage)
+{
+    uint8_t duty_cycle = config->pwmMap[stage];
+
+    return duty_cycle > 100 ? 100 : duty_cycle;
+}
+
+/**
+ * @brief       Load config.
+ *
+ * pwmMap[i] is the output at input (i + 1) * 10%, inputs below 10% keep the
+ * output of the first stage. The stages are interpolated in 8.8 fixed point
+ * into l_pwm_lut, so a control step is a lookup.
+ */
+void control_load_config(const struct FirmwareConfig *config)
+{
+    uint8_t input = 0;
+    for (; input < PWM_STAGE_WIDTH; ++input) {
+        l_pwm_lut[input] = pwm_stage(config, 0);
+    }
+
+    for (uint8_t stage = 1; stage < PWM_STAGES; ++stage) {
+        uint8_t  begin = pwm_stage(config, stage - 1);
+        int16_t  step  = ((int16_t)pwm_stage(config, stage) - begin) * 256
+                        / PWM_STAGE_WIDTH;
+        uint16_t value = ((uint16_t)begin << 8) | 0x80;
+        for (uint8_t i = 0; i < PWM_STAGE_WIDTH; ++i) {
+            l_pwm_lut[input++] = (uint8_t)(value >> 8);
+            value += step;
+        }
+    }
+
+    l_pwm_lut[input] = pwm_stage(config, PWM_STAGES - 1);
+
+    // The divisions are done here, mapping a speed is a multiplication.
+    for (uint8_t i = 0; i < SPEED_POINTS; ++i) {
+        l_speed_source[i] = config->speedMap[i].source;
+        l_speed_dest[i]   = (uint32_t)config->speedMap[i].dest << 8;
+        l_speed_slope[i]  = 0;
+        if (i + 1 < SPEED_POINTS
+            && config->speedMap[i + 1].source > config->speedMap[i].source) {
+            l_speed_slope[i] = ((int32_t)config->speedMap[i + 1].dest
+                                - config->speedMap[i].dest)
+                               * 256
+                               / (config->speedMap[i + 1].source
+                                  - config->speedMap[i].source);
+        }
+    }
+    l_speed_input = SPEED_INVALID;
+}
+
+/**
+ * @brief       Map input speed through speedMap.
+ *
+ * The sources are ascending, speeds out of the map keep the dest of the
+ * nearest point, a stopped fan is reported as stopped.
+ *
+ * @param[in]   speed       Input speed(Hz).
+ *
+ * @return      Output speed(1/16 Hz).
+ */
+static uint32_t map_speed(uint16_t speed)
+{
+    uint8_t i = SPEED_POINTS - 1;
+
+    if (speed == 0) {
+        return 0;
+    }
+
+    while (i > 0 && speed < l_speed_source[i]) {
+        --i;
+    }
+    if (speed <= l_speed_source[i]) {
+        return l_speed_dest[i] >> 4;
+    }
+
+    return (l_speed_dest[i]
+            + (uint32_t)((int32_t)(speed - l_speed_source[i])
+                         * l_speed_slope[i]))
+           >> 4;
+}
+
+/**
+ * @brief       Run a step of the control loop.
+ *
+ * In normal mode the output duty cycle follows the input duty cycle through
+ * pwmMap, the output speed follows the input speed through speedMap.
+ */
+void control_step()
+{
+    if (current_mode() != FIRMWARE_MODE_NORMAL) {
+        l_speed_input = SPEED_INVALID;
+        return;
+    }
+
+    uint8_t duty_cycle = l_pwm_lut[input_pwm()];
+    if (duty_cycle != output_pwm()) {
+        set_output_pwm(duty_cycle);
+    }
+
+    uint16_t speed = input_speed();
+    if (speed != l_speed_input) {
+        l_speed_input = speed;
+        set_output_speed(map_speed(speed));
+    }
+}
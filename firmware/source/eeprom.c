@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include <types.h>
 
 #include <eeprom.h>
@@ -25,6 +27,11 @@ _Static_assert(sizeof(struct record_allocation_table) < RECORD_SIZE,
 
 static __xdata struct record_allocation_table rat; ///< Record allocation table.
 
+/// Active record, config is read from here and written back by
+/// eeprom_flush() when dirty.
+static __xdata struct config_record l_record;
+static __data bool                  l_record_dirty = false; ///< Not flushed.
+
 /**
  * @brief       Read byte.
  *
@@ -41,8 +48,7 @@ static bool eeprom_read_byte(uint16_t addr, uint8_t *byte)
     IAP_ADDRH = (addr & 0xFF00) >> 8;
     IAP_CMD &= 0xFC;
     IAP_CMD |= 0x01;
-    IAP_TRIG = 0x5A;
-    IAP_TRIG = 0xA5;
+    IAP_TRIGGER();
 
     if (IAP_CONTR & 0x10) {
         return false;
@@ -68,9 +74,8 @@ static bool eeprom_write_byte(uint16_t addr, uint8_t byte)
     IAP_ADDRH = (addr & 0xFF00) >> 8;
     IAP_DATA  = byte;
     IAP_CMD &= 0xFC;
-    IAP_CMD |= 0x10;
-    IAP_TRIG = 0x5A;
-    IAP_TRIG = 0xA5;
+    IAP_CMD |= 0x02;
+    IAP_TRIGGER();
 
     if (IAP_CONTR & 0x10) {
         return false;
@@ -133,9 +138,8 @@ static int8_t eeprom_erase(uint16_t addr)
     IAP_ADDRL = addr & 0xFF;
     IAP_ADDRH = (addr & 0xFF00) >> 8;
     IAP_CMD &= 0xFC;
-    IAP_CMD |= 0x11;
-    IAP_TRIG = 0x5A;
-    IAP_TRIG = 0xA5;
+    IAP_CMD |= 0x03;
+    IAP_TRIGGER();
 
     if (IAP_CONTR & 0x10) {
         return -1;
@@ -343,6 +347,28 @@ uint16_t allocate_write_addr()
     }
 }
 
+/**
+ * @brief       Read record.
+ *
+ * @param[out]  record      Record.
+ */
+static void eeprom_read_record(struct config_record *record)
+{
+    uint16_t addr = get_read_addr();
+    eeprom_read_bytes(addr, (uint8_t *)record, sizeof(struct config_record));
+}
+
+/**
+ * @brief       Write record.
+ *
+ * @param[in]   record      Record.
+ */
+static void eeprom_write_record(struct config_record *record)
+{
+    uint16_t addr = allocate_write_addr();
+    eeprom_write_bytes(addr, (uint8_t *)record, sizeof(struct config_record));
+}
+
 /**
  * @brief       Initialize.
  */
@@ -360,32 +386,47 @@ void eeprom_init()
         eeprom_format();
 
         // Make default record.
-        __xdata struct config_record default_record;
         for (uint8_t i = 0; i < 10; ++i) {
-            default_record.config.pwmMap[i]          = 100;
-            default_record.config.speedMap[i].source = 2000 * 2 * i / 60;
-            default_record.config.speedMap[i].dest   = 2000 * 2 * i / 60;
+            l_record.config.pwmMap[i]          = 100;
+            l_record.config.speedMap[i].source = 2000 * 2 * i / 60;
+            l_record.config.speedMap[i].dest   = 2000 * 2 * i / 60;
         }
 
         // Write record.
-        eeprom_write_record(&default_record);
+        eeprom_write_record(&l_record);
+    } else {
+        eeprom_read_record(&l_record);
     }
 }
 
 /**
- * @brief       Read record.
+ * @brief       Get config.
  */
-void eeprom_read_record(struct config_record *record)
+__xdata struct FirmwareConfig *eeprom_config()
 {
-    uint16_t addr = get_read_addr();
-    eeprom_read_bytes(addr, (uint8_t *)record, sizeof(struct config_record));
+    return &l_record.config;
 }
 
 /**
- * @brief       Write record.
+ * @brief       Set config.
  */
-void eeprom_write_record(struct config_record *record)
+void eeprom_set_config(const struct FirmwareConfig *config)
 {
-    uint16_t addr = allocate_write_addr();
-    eeprom_write_bytes(addr, (uint8_t *)record, sizeof(struct config_record));
+    memcpy(&l_record.config, config, sizeof(struct FirmwareConfig));
+    l_record_dirty = true;
+}
+
+/**
+ * @brief       Flush config.
+ *
+ * The CPU is held while IAP is programming, so this is called only from the
+ * main loop when serial is idle, never while a command is being handled or
+ * frames are still arriving.
+ */
+void eeprom_flush()
+{
+    if (l_record_dirty) {
+        l_record_dirty = false;
+        eeprom_write_record(&l_record);
+    }
 }
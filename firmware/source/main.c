@@ -1,4 +1,6 @@
 #include <clock_io.h>
+#include <control.h>
+#include <eeprom.h>
 #include <platform.h>
 #include <serial.h>
 
@@ -9,6 +11,15 @@ int main()
 
     while (1) {
         timer0_isr_second_stage();
+        control_step();
+        serial_poll();
+        serial_push_telemetry();
+        serial_switch_baud_rate();
+        serial_check_link();
+        if (serial_idle()) {
+            eeprom_flush();
+        }
+        PLATFORM_IDLE();
         // PCON |= 0x01;
     }
 }
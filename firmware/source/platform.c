@@ -1,4 +1,5 @@
 #include <clock_io.h>
+#include <control.h>
 #include <eeprom.h>
 #include <platform.h>
 #include <serial.h>
@@ -38,7 +39,8 @@ void platform_init()
     // Initialize eeprom.
     eeprom_init();
 
-    // Initialize pwm.
+    // Initialize control.
+    control_init();
 
     // Enable interruption.
     IE |= 0x80;
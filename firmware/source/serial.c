@@ -1,10 +1,97 @@
+#include <string.h>
+
 #include <command.h>
 
 #include <clock_io.h>
+#include <control.h>
+#include <eeprom.h>
 #include <platform.h>
 #include <serial.h>
 
-#define READ_TIMEOUT 100000 ///< 100ms
+#define READ_TIMEOUT       100000 ///< 100ms between bytes of a frame.
+#define LINK_CHECK_TIMEOUT ((uint32_t)SERIAL_LINK_CHECK_TIMEOUT_MS * 1000)
+#define IDLE_TIMEOUT       50000 ///< 50ms without a byte received.
+
+/// Timer1 reload value of the baud rate, Timer1 in 1T mode, SMOD = 0.
+/// Baud rate = SYSCLK / 32 / (256 - reload).
+#define BAUD_RATE_DIVISOR(baud_rate) ((SYSCLK / 32) / (baud_rate))
+#define BAUD_RATE_RELOAD(baud_rate) \
+    ((uint8_t)(256 - BAUD_RATE_DIVISOR(baud_rate)))
+
+/// Size of receive ring, must be a power of 2.
+#define RX_RING_SIZE 64
+
+static __xdata uint8_t l_rx_ring[RX_RING_SIZE]; ///< Bytes received.
+static volatile __data uint8_t l_rx_head
+    = 0; ///< Next byte to parse, written by main loop.
+static volatile __data uint8_t l_rx_tail
+    = 0; ///< Next free byte, written by serial ISR.
+
+/// States of frame parser.
+#define RX_STATE_BEGIN    0 ///< Waiting for the beginning of the frame.
+#define RX_STATE_LENGTH   1 ///< Waiting for the length.
+#define RX_STATE_SEQUENCE 2 ///< Waiting for the sequence.
+#define RX_STATE_PAYLOAD  3 ///< Receiving payload.
+#define RX_STATE_CRC      4 ///< Waiting for the crc.
+
+static __data uint8_t  l_rx_state     = RX_STATE_BEGIN; ///< Parser state.
+static __data uint8_t  l_rx_index     = 0; ///< Index of next payload byte.
+static __data uint8_t  l_rx_crc       = 0; ///< Crc of the bytes parsed.
+static __data uint32_t l_rx_byte_time = 0; ///< Boot time of last byte.
+
+static __data uint8_t l_sequence = 0; ///< Sequence of current command.
+static __xdata uint8_t
+    l_payload[FRAME_PAYLOAD_MAX_SIZE]; ///< Payload of current command.
+static __data uint8_t l_payload_size = 0; ///< Size of current payload.
+
+#define FRAME_OVERHEAD_SIZE (sizeof(struct FrameHeader) + 1)
+
+/// Size of transmit ring, 256 so the indexes wrap by themselves. It holds
+/// more than the replies of the commands in flight and a frame pushed.
+#define TX_RING_SIZE 256
+
+static __xdata uint8_t l_tx_ring[TX_RING_SIZE]; ///< Bytes to send.
+static volatile __data uint8_t l_tx_head
+    = 0; ///< Next byte to send, written by serial ISR.
+static volatile __data uint8_t l_tx_tail
+    = 0; ///< Next free byte, written by main loop.
+static volatile __data bool l_tx_busy
+    = false; ///< Sending, cleared by serial ISR when the ring is empty.
+
+static __data uint16_t l_telemetry_interval
+    = 0; ///< Min interval of telemetry pushes(ms), 0 if not subscribed.
+static __data uint32_t l_telemetry_push_time
+    = 0; ///< Boot time of last telemetry push.
+
+static __xdata struct FirmwareConfig
+    l_config; ///< Config being written, applied by CommitConfig.
+static __data bool l_config_writing
+    = false; ///< l_config has been loaded from the active config.
+
+static __data uint8_t l_baud_rate_reload
+    = 0; ///< Timer1 reload to switch to after replies sent, 0 if none.
+/// States of the link check after switching baud rate.
+#define LINK_CHECK_NONE    0 ///< Not checking.
+#define LINK_CHECK_WAITING 1 ///< Waiting for the first frame.
+#define LINK_CHECK_REPLIED 2 ///< Replied, waiting for the confirming frame.
+
+static __data uint8_t l_link_check_state
+    = LINK_CHECK_NONE; ///< State of the link check.
+static __data uint32_t l_link_check_begin_time
+    = 0; ///< Boot time of switching baud rate.
+
+/**
+ * @brief       Set Timer1 reload value.
+ *
+ * @param[in]   reload      Reload value.
+ */
+static void serial_set_reload(uint8_t reload)
+{
+    TCON &= 0xBF;
+    TL1 = reload;
+    TH1 = reload;
+    TCON |= 0x40;
+}
 
 /**
  * @brief       Initialize serial.
@@ -14,13 +101,11 @@ void serial_init()
     // Enable serial.
     PCON &= 0x7F;
     SCON = 0x50;
-    AUXR &= 0xBF;
+    AUXR |= 0x40;
     AUXR &= 0xFE;
     TMOD &= 0x0F;
     TMOD |= 0x20;
-    TL1 = 0xF7;
-    TH1 = 0xF7;
-    TCON |= 0x40;
+    serial_set_reload(BAUD_RATE_RELOAD(SERIAL_DEFAULT_BAUD_RATE));
 }
 
 /**
@@ -32,67 +117,127 @@ void enable_serial()
 }
 
 /**
- * @brief       Read byte.
+ * @brief       Parse byte received.
+ *
+ * Bytes before the beginning of the frame are dropped, a frame with bad
+ * length or crc is dropped.
  *
- * @param[out]  byte        Byte read. Do not change when failed.
+ * @param[in]   byte        Byte received.
  *
- * @return      On success, the method  returns 0, otherwise returns -1.
+ * @return      \c true if a frame has been received, otherwise returns
+ *              \c false.
  */
-static int serial_read_byte(uint8_t *byte)
+static bool serial_parse_byte(uint8_t byte)
 {
-    __idata uint32_t begin_time = boot_time();
+    switch (l_rx_state) {
+        case RX_STATE_BEGIN: {
+            if (byte == FRAME_BEGIN) {
+                l_rx_state = RX_STATE_LENGTH;
+            }
+            return false;
+        }
 
-    // Wait for data.
-    while (! (SCON & 0x01)) {
-        if (boot_time() - begin_time > READ_TIMEOUT) {
-            // Timeout.
-            return -1;
+        case RX_STATE_LENGTH: {
+            if (byte == 0 || byte > FRAME_PAYLOAD_MAX_SIZE) {
+                l_rx_state = RX_STATE_BEGIN;
+                return false;
+            }
+            l_payload_size = byte;
+            l_rx_crc       = frame_crc_update(FRAME_CRC_INIT, byte);
+            l_rx_state     = RX_STATE_SEQUENCE;
+            return false;
+        }
+
+        case RX_STATE_SEQUENCE: {
+            l_sequence = byte;
+            l_rx_crc   = frame_crc_update(l_rx_crc, byte);
+            l_rx_index = 0;
+            l_rx_state = RX_STATE_PAYLOAD;
+            return false;
+        }
+
+        case RX_STATE_PAYLOAD: {
+            l_payload[l_rx_index] = byte;
+            l_rx_crc              = frame_crc_update(l_rx_crc, byte);
+            ++l_rx_index;
+            if (l_rx_index == l_payload_size) {
+                l_rx_state = RX_STATE_CRC;
+            }
+            return false;
         }
-    }
 
-    // Read.
-    *byte = SBUF;
-    SCON &= 0xFE;
+        case RX_STATE_CRC: {
+            l_rx_state = RX_STATE_BEGIN;
+            return byte == l_rx_crc;
+        }
 
-    return 0;
+        default: {
+            l_rx_state = RX_STATE_BEGIN;
+            return false;
+        }
+    }
 }
 
 /**
- * @brief       Write byte.
+ * @brief       Queue frame.
  *
- * @param[in]  byte        Byte to write.
+ * The frame is sent by serial ISR, it is dropped if the ring is full.
+ *
+ * @param[in]   sequence    Sequence number.
+ * @param[in]   payload     Payload.
+ * @param[in]   size        Size of payload.
  */
-static void serial_write_byte(uint8_t byte)
+static void serial_queue_frame(uint8_t sequence, uint8_t *payload, uint8_t size)
 {
-    // Clear send status.
-    SCON &= 0xFD;
+    if ((uint8_t)(TX_RING_SIZE - 1 - (uint8_t)(l_tx_tail - l_tx_head))
+        < size + FRAME_OVERHEAD_SIZE) {
+        return;
+    }
 
-    // Send.
-    SBUF = byte;
+    // Fill the frame after the tail, serial ISR does not read it until the
+    // tail is moved.
+    __data uint8_t tail = l_tx_tail;
+    l_tx_ring[tail++]   = FRAME_BEGIN;
+    l_tx_ring[tail++]   = size;
+    l_tx_ring[tail++]   = sequence;
 
-    // Wait.
-    while (! (SCON & 0x02)) {
+    __data uint8_t crc = frame_crc_update(FRAME_CRC_INIT, size);
+    crc                = frame_crc_update(crc, sequence);
+    for (uint8_t i = 0; i < size; ++i) {
+        l_tx_ring[tail++] = payload[i];
+        crc               = frame_crc_update(crc, payload[i]);
     }
-    // Clear send status.
-    SCON &= 0xFD;
-
-    return;
+    l_tx_ring[tail++] = crc;
+
+    // Start sending if serial ISR has stopped.
+    IE &= 0xEF;
+    l_tx_tail = tail;
+    if (! l_tx_busy) {
+        l_tx_busy = true;
+        UART_SEND(l_tx_ring[l_tx_head++]);
+    }
+    IE |= 0x10;
 }
 
 /**
- * @brief       Write bytes.
+ * @brief       Queue reply of current command.
  *
- * @param[in]  bytes        Bytes to write.
- * @param[in]  size         Size of bytes.
+ * @param[in]   reply       Reply.
+ * @param[in]   size        Size of reply.
  */
-static void serial_write_bytes(uint8_t *bytes, uint8_t size)
+static void serial_reply(uint8_t *reply, uint8_t size)
 {
-    for (uint8_t i = 0; i < size; ++i) {
-        serial_write_byte(*bytes);
-        ++bytes;
-    }
+    serial_queue_frame(l_sequence, reply, size);
+}
 
-    return;
+/**
+ * @brief       Send failed reply of current command.
+ */
+static void serial_reply_failed()
+{
+    __xdata struct ReplyFailed reply;
+    reply.header.replyType = REPLY_TYPE_FAILED;
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
 /**
@@ -103,39 +248,45 @@ static void cmd_get_mode()
     __xdata struct ReplyGetMode reply;
     reply.header.replyType = REPLY_TYPE_SUCCESS;
     reply.mode             = current_mode();
-    serial_write_bytes((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
 /**
  * @brief       Set firmware mode.
- *
- * @param[in]   mode    Mode.
  */
-static void cmd_set_mode(uint8_t mode)
+static void cmd_set_mode()
 {
-    set_current_mode(mode);
+    __xdata struct CMDSetMode *cmd = (__xdata struct CMDSetMode *)l_payload;
+
+    // Check.
+    switch (cmd->mode) {
+        case FIRMWARE_MODE_NORMAL:
+        case FIRMWARE_MODE_MANUAL:
+        case FIRMWARE_MODE_TEST:
+            break;
+
+        default:
+            serial_reply_failed();
+            return;
+    }
+
+    set_current_mode(cmd->mode);
     __xdata struct ReplySetMode reply;
     reply.header.replyType = REPLY_TYPE_SUCCESS;
-    serial_write_bytes((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
 /**
  * @brief       Read output port.
- *
- * @param[in]   port        Port to read.
  */
-static void cmd_read_port(uint8_t port)
+static void cmd_read_port()
 {
-    // Check.
-    if (current_mode() != FIRMWARE_MODE_TEST) {
-        serial_write_byte(REPLY_TYPE_FAILED);
-        return;
-    }
+    __xdata struct CMDReadPort *cmd = (__xdata struct CMDReadPort *)l_payload;
 
     // Reply.
     __xdata struct ReplyReadPort reply;
     reply.header.replyType = REPLY_TYPE_SUCCESS;
-    switch (port) {
+    switch (cmd->port) {
         case PORT_READ_PWM_INPUT:
             reply.value = PWM_INPUT ? 1 : 0;
             break;
@@ -143,39 +294,46 @@ static void cmd_read_port(uint8_t port)
         case PORT_READ_SPEED_INPUT:
             reply.value = SPEED_INPUT ? 1 : 0;
             break;
+
+        default:
+            serial_reply_failed();
+            return;
     }
 
-    serial_write_bytes((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
 /**
  * @brief       Write input port.
- *
- * @param[in]   port        Port to read.
- * @param[in]   value       Value to write.
  */
-static void cmd_write_port(uint8_t port, uint8_t value)
+static void cmd_write_port()
 {
+    __xdata struct CMDWritePort *cmd = (__xdata struct CMDWritePort *)l_payload;
+
     // Check.
-    if (current_mode() != FIRMWARE_MODE_TEST) {
-        serial_write_byte(REPLY_TYPE_FAILED);
+    if (cmd->value > 1) {
+        serial_reply_failed();
         return;
     }
 
     // Reply.
     __xdata struct ReplyWritePort reply;
     reply.header.replyType = REPLY_TYPE_SUCCESS;
-    switch (port) {
+    switch (cmd->port) {
         case PORT_WRITE_SPEED_OUTPUT:
-            SPEED_OUTPUT = value ? 1 : 0;
+            SPEED_OUTPUT = cmd->value;
             break;
 
         case PORT_WRITE_PWM_OUTPUT:
-            PWM_OUTPUT = value ? 1 : 0;
+            PWM_OUTPUT = cmd->value;
             break;
+
+        default:
+            serial_reply_failed();
+            return;
     }
 
-    serial_write_bytes((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
 /**
@@ -188,283 +346,473 @@ static void cmd_get_input_speed()
     reply.header.replyType = REPLY_TYPE_SUCCESS;
     reply.speed            = input_speed();
 
-    serial_write_bytes((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
 /**
  * @brief       Get input pwm.
  */
-static void cmd_get_input_pwm() {}
+static void cmd_get_input_pwm()
+{
+    // Reply.
+    __xdata struct ReplyGetInputPWM reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
+    reply.dutyCycle        = input_pwm();
+    reply.frequency        = input_pwm_frequency();
 
-/**
- * @brief       Set output speed.
- */
-static void cmd_set_output_speed() {}
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+}
 
 /**
- * @brief       Set output pwm.
+ * @brief       Get telemetry.
  */
-static void cmd_set_output_pwn() {}
+static void cmd_get_telemetry()
+{
+    // Reply.
+    __xdata struct ReplyGetTelemetry reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
+    reply.speed            = input_speed();
+    reply.dutyCycle        = input_pwm();
+    reply.frequency        = input_pwm_frequency();
+    reply.bootTime         = boot_time();
 
-/**
- * @brief       Set output pwm.
- */
-static void cmd_set_pwm() {}
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+}
 
 /**
- * @brief       Read config.
+ * @brief       Subscribe telemetry.
  */
-static void cmd_read_config() {}
+static void cmd_subscribe_telemetry()
+{
+    __xdata struct CMDSubscribeTelemetry *cmd
+        = (__xdata struct CMDSubscribeTelemetry *)l_payload;
+    l_telemetry_interval  = cmd->interval;
+    l_telemetry_push_time = boot_time();
 
-/**
- * @brief       Write config.
- */
-static void cmd_write_config() {}
+    // Reply.
+    __xdata struct ReplySubscribeTelemetry reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
+
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+}
 
 /**
- * @brief       Read clock.
+ * @brief       Set the method to measure input speed.
  */
-static void cmd_read_clock()
+static void cmd_set_speed_method()
 {
+    __xdata struct CMDSetSpeedMethod *cmd
+        = (__xdata struct CMDSetSpeedMethod *)l_payload;
+
+    // Check.
+    if (cmd->method > SPEED_METHOD_COUNTING) {
+        serial_reply_failed();
+        return;
+    }
+    set_speed_method(cmd->method);
+
     // Reply.
-    __xdata struct ReplyReadClock reply;
+    __xdata struct ReplySetSpeedMethod reply;
     reply.header.replyType = REPLY_TYPE_SUCCESS;
-    reply.bootTime         = boot_time();
 
-    serial_write_bytes((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
 /**
- * @brief       Handle command.
+ * @brief       Set the window to count edges of input speed.
  */
-static void serial_on_command()
+static void cmd_set_speed_window()
 {
-    __xdata uint8_t byte;
+    __xdata struct CMDSetSpeedWindow *cmd
+        = (__xdata struct CMDSetSpeedWindow *)l_payload;
 
-    // Read first byte.
-    if (serial_read_byte(&byte) < 0) {
-        serial_write_byte(REPLY_TYPE_FAILED);
-        return;
-    }
-    // Parse beginning of the command.
-    if (byte != CMD_BEGIN) {
-        serial_write_byte(REPLY_TYPE_FAILED);
+    // Check.
+    if (cmd->window == 0 || cmd->window > SPEED_WINDOW_MAX_MS
+        || cmd->window % SPEED_SUB_WINDOW_MS != 0) {
+        serial_reply_failed();
         return;
     }
+    set_speed_window((uint8_t)(cmd->window / SPEED_SUB_WINDOW_MS));
 
-_PARSE_CMD:
-    // Read second byte.
-    if (serial_read_byte(&byte) < 0) {
-        serial_write_byte(REPLY_TYPE_FAILED);
-        return;
-    }
+    // Reply.
+    __xdata struct ReplySetSpeedWindow reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
 
-    // Parse command.
-    switch (byte) {
-        case CMD_BEGIN: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            goto _PARSE_CMD;
-        }
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+}
 
-        case CMD_TYPE_GET_MODE: {
-            goto _PARSE_CMD_GET_MODE;
-        }
+/**
+ * @brief       Set output speed.
+ */
+static void cmd_set_output_speed()
+{
+    __xdata struct CMDSetOutputSpeed *cmd
+        = (__xdata struct CMDSetOutputSpeed *)l_payload;
 
-        case CMD_TYPE_SET_MODE: {
-            goto _PARSE_CMD_SET_MODE;
-        }
+    set_output_speed((uint32_t)cmd->speed << 4);
 
-        case CMD_TYPE_READ_PORT: {
-            goto _PARSE_CMD_READ_PORT;
-        }
+    // Reply.
+    __xdata struct ReplySetOutputSpeed reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
 
-        case CMD_TYPE_WRITE_PORT: {
-            goto _PARSE_CMD_WRITE_PORT;
-        }
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+}
 
-        case CMD_TYPE_GET_INPUT_SPEED: {
-            goto _PARSE_CMD_GET_INPUT_SPEED;
-        }
+/**
+ * @brief       Set output PWM.
+ */
+static void cmd_set_output_pwm()
+{
+    __xdata struct CMDSetOutputPWM *cmd
+        = (__xdata struct CMDSetOutputPWM *)l_payload;
 
-        case CMD_TYPE_GET_INPUT_PWM: {
-            goto _PARSE_CMD_GET_INPUT_PWM;
-        }
+    // Check.
+    if (cmd->dutyCycle > 100) {
+        serial_reply_failed();
+        return;
+    }
+    set_output_pwm(cmd->dutyCycle);
 
-        case CMD_TYPE_SET_OUTPUT_SPEED: {
-            goto _PARSE_CMD_SET_OUTPUT_SPEED;
-        }
+    // Reply.
+    __xdata struct ReplySetOutputPWM reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
 
-        case CMD_TYPE_SET_OUTPUT_PWM: {
-            goto _PARSE_CMD_SET_OUTPUT_PWM;
-        }
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+}
 
-        case CMD_TYPE_READ_CONFIG: {
-            goto _PARSE_CMD_READ_CONFIG;
-        }
+/**
+ * @brief       Check the range of a config chunk.
+ *
+ * @param[in]   offset      Offset of the chunk.
+ * @param[in]   length      Size of the chunk.
+ *
+ * @return      \c true if the chunk is in FirmwareConfig, otherwise returns
+ *              \c false.
+ */
+static bool config_chunk_valid(uint8_t offset, uint8_t length)
+{
+    return length <= CONFIG_CHUNK_MAX_SIZE
+           && offset <= (uint8_t)sizeof(struct FirmwareConfig)
+           && length <= (uint8_t)sizeof(struct FirmwareConfig) - offset;
+}
 
-        case CMD_TYPE_WRITE_CONFIG: {
-            goto _PARSE_CMD_WRITE_CONFIG;
-        }
+/**
+ * @brief       Read config.
+ */
+static void cmd_read_config()
+{
+    __xdata struct CMDReadConfig *cmd
+        = (__xdata struct CMDReadConfig *)l_payload;
 
-        case CMD_TYPE_READ_CLOCK: {
-            goto _PARSE_CMD_READ_CLOCK;
-        }
+    // Check.
+    if (! config_chunk_valid(cmd->offset, cmd->length)) {
+        serial_reply_failed();
+        return;
+    }
 
-        default: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            return;
-        }
+    // Reply.
+    __xdata struct ReplyReadConfig reply;
+    __xdata uint8_t *config = (__xdata uint8_t *)eeprom_config();
+    reply.header.replyType  = REPLY_TYPE_SUCCESS;
+    reply.offset            = cmd->offset;
+    reply.length            = cmd->length;
+    for (uint8_t i = 0; i < CONFIG_CHUNK_MAX_SIZE; ++i) {
+        reply.data[i] = i < cmd->length ? config[cmd->offset + i] : 0;
     }
+    reply.crc = config_chunk_crc(reply.offset, reply.length, reply.data);
 
-    // Parse commands.
-_PARSE_CMD_GET_MODE : {
-    cmd_get_mode();
-    return;
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
-_PARSE_CMD_SET_MODE : {
-    // Read first argument.
-    if (serial_read_byte(&byte) < 0) {
-        serial_write_byte(REPLY_TYPE_FAILED);
+/**
+ * @brief       Write config.
+ *
+ * The chunk is written to l_config, the active config is not touched until
+ * CommitConfig.
+ */
+static void cmd_write_config()
+{
+    __xdata struct CMDWriteConfig *cmd
+        = (__xdata struct CMDWriteConfig *)l_payload;
+
+    // Check.
+    if (! config_chunk_valid(cmd->offset, cmd->length)
+        || config_chunk_crc(cmd->offset, cmd->length, cmd->data)
+               != cmd->crc) {
+        serial_reply_failed();
         return;
     }
 
-    // Parse first argument.
-    switch (byte) {
-        case CMD_BEGIN: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            goto _PARSE_CMD;
-        }
+    // Write.
+    if (! l_config_writing) {
+        memcpy(&l_config, eeprom_config(), sizeof(l_config));
+        l_config_writing = true;
+    }
+    for (uint8_t i = 0; i < cmd->length; ++i) {
+        ((__xdata uint8_t *)(&l_config))[cmd->offset + i] = cmd->data[i];
+    }
 
-        case FIRMWARE_MODE_NORMAL:
-        case FIRMWARE_MODE_MANUAL:
-        case FIRMWARE_MODE_TEST: {
-            cmd_set_mode(byte);
-            return;
-        }
+    // Reply.
+    __xdata struct ReplyWriteConfig reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
 
-        default: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            return;
-        }
-    }
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
-_PARSE_CMD_READ_PORT : {
-    // Read first argument.
-    if (serial_read_byte(&byte) < 0) {
-        serial_write_byte(REPLY_TYPE_FAILED);
+/**
+ * @brief       Commit config.
+ *
+ * The config is applied at once and saved to eeprom by main loop. A commit
+ * resent after its reply was lost finds the config committed and succeeds.
+ */
+static void cmd_commit_config()
+{
+    __xdata struct CMDCommitConfig *cmd
+        = (__xdata struct CMDCommitConfig *)l_payload;
+
+    // Check.
+    __xdata uint8_t *config = l_config_writing
+                                  ? (__xdata uint8_t *)(&l_config)
+                                  : (__xdata uint8_t *)eeprom_config();
+    if (config_chunk_crc(0, (uint8_t)sizeof(l_config), config) != cmd->crc) {
+        // Discard the chunks staged, the host writes all chunks again.
+        l_config_writing = false;
+        serial_reply_failed();
         return;
     }
 
-    // Parse first argument.
-    switch (byte) {
-        case CMD_BEGIN: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            goto _PARSE_CMD;
-        }
+    // Commit.
+    if (l_config_writing) {
+        eeprom_set_config(&l_config);
+        control_load_config(eeprom_config());
+        l_config_writing = false;
+    }
 
-        case PORT_READ_PWM_INPUT:
-        case PORT_READ_SPEED_INPUT: {
-            cmd_read_port(byte);
-            return;
-        }
+    // Reply.
+    __xdata struct ReplyCommitConfig reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
 
-        default: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            return;
-        }
-    }
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+}
+
+/**
+ * @brief       Read clock.
+ */
+static void cmd_read_clock()
+{
+    // Reply.
+    __xdata struct ReplyReadClock reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
+    reply.bootTime         = boot_time();
+
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
 }
 
-_PARSE_CMD_WRITE_PORT : {
-    // Read first argument.
-    __xdata uint8_t port;
-    if (serial_read_byte(&port) < 0) {
-        serial_write_byte(REPLY_TYPE_FAILED);
+/**
+ * @brief       Set baud rate.
+ */
+static void cmd_set_baud_rate()
+{
+    __xdata struct CMDSetBaudRate *cmd
+        = (__xdata struct CMDSetBaudRate *)l_payload;
+
+    // Check, only the baud rates which can be generated exactly are
+    // accepted.
+    if (cmd->baudRate < SERIAL_DEFAULT_BAUD_RATE
+        || cmd->baudRate > SERIAL_MAX_BAUD_RATE
+        || (SYSCLK / 32) % cmd->baudRate != 0) {
+        serial_reply_failed();
         return;
     }
 
-    // Parse first argument.
-    switch (port) {
-        case CMD_BEGIN: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            goto _PARSE_CMD;
-        }
+    // Switched after the reply has been sent.
+    l_baud_rate_reload = BAUD_RATE_RELOAD(cmd->baudRate);
 
-        case PORT_WRITE_SPEED_OUTPUT:
-        case PORT_WRITE_PWM_OUTPUT: {
-            break;
-        }
+    // Reply.
+    __xdata struct ReplySetBaudRate reply;
+    reply.header.replyType = REPLY_TYPE_SUCCESS;
 
-        default: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            return;
-        }
+    serial_reply((uint8_t *)(&reply), (uint8_t)sizeof(reply));
+}
+
+/// Modes in which a command is accepted.
+#define MODE_MASK(mode) ((uint8_t)(1 << (mode)))
+#define MODE_MASK_ALL                                                    \
+    (MODE_MASK(FIRMWARE_MODE_NORMAL) | MODE_MASK(FIRMWARE_MODE_MANUAL) \
+     | MODE_MASK(FIRMWARE_MODE_TEST))
+#define MODE_MASK_MANUAL MODE_MASK(FIRMWARE_MODE_MANUAL)
+#define MODE_MASK_TEST   MODE_MASK(FIRMWARE_MODE_TEST)
+
+/**
+ * @brief       Command entry.
+ */
+struct CommandEntry {
+    uint8_t size;  ///< Size of the command.
+    uint8_t modes; ///< Modes in which the command is accepted.
+    void (*handler)(void); ///< Handler, serial_reply_failed if not implemented.
+};
+
+/// Commands, grouped by the high nibble of the command type and indexed by
+/// the low nibble in the group.
+static __code struct CommandEntry l_commands[] = {
+    // 0x0X
+    {sizeof(struct CMDGetMode), MODE_MASK_ALL, cmd_get_mode},
+    {sizeof(struct CMDSetMode), MODE_MASK_ALL, cmd_set_mode},
+
+    // 0x1X
+    {sizeof(struct CMDReadPort), MODE_MASK_TEST, cmd_read_port},
+    {sizeof(struct CMDWritePort), MODE_MASK_TEST, cmd_write_port},
+
+    // 0x2X
+    {sizeof(struct CMDGetInputSpeed), MODE_MASK_ALL, cmd_get_input_speed},
+    {sizeof(struct CMDGetInputPWM), MODE_MASK_ALL, cmd_get_input_pwm},
+    {sizeof(struct CMDGetTelemetry), MODE_MASK_ALL, cmd_get_telemetry},
+    {sizeof(struct CMDSubscribeTelemetry), MODE_MASK_ALL,
+     cmd_subscribe_telemetry},
+    {sizeof(struct CMDSetSpeedMethod), MODE_MASK_ALL, cmd_set_speed_method},
+    {sizeof(struct CMDSetSpeedWindow), MODE_MASK_ALL, cmd_set_speed_window},
+
+    // 0x3X
+    {sizeof(struct CMDSetOutputSpeed), MODE_MASK_MANUAL,
+     cmd_set_output_speed},
+    {sizeof(struct CMDSetOutputPWM), MODE_MASK_MANUAL, cmd_set_output_pwm},
+
+    // 0x4X
+    {sizeof(struct CMDReadConfig), MODE_MASK_ALL, cmd_read_config},
+    {sizeof(struct CMDWriteConfig), MODE_MASK_ALL, cmd_write_config},
+    {sizeof(struct CMDCommitConfig), MODE_MASK_ALL, cmd_commit_config},
+
+    // 0x5X
+    {sizeof(struct CMDReadClock), MODE_MASK_ALL, cmd_read_clock},
+
+    // 0x6X
+    {sizeof(struct CMDSetBaudRate), MODE_MASK_ALL, cmd_set_baud_rate},
+};
+
+/// Index of the first command of each group in l_commands.
+static __code uint8_t l_command_group_begin[] = {0, 2, 4, 10, 12, 15, 16};
+
+/// Number of commands in each group.
+static __code uint8_t l_command_group_size[] = {2, 2, 6, 2, 3, 1, 1};
+
+#define COMMAND_GROUP_NUM \
+    (sizeof(l_command_group_begin) / sizeof(l_command_group_begin[0]))
+
+/**
+ * @brief       Handle command received.
+ */
+static void serial_on_command()
+{
+    // A frame after a reply at new baud rate means the host has received it,
+    // the reply of the first frame may be lost so the link is not confirmed.
+    if (l_link_check_state == LINK_CHECK_WAITING) {
+        l_link_check_state = LINK_CHECK_REPLIED;
+    } else {
+        l_link_check_state = LINK_CHECK_NONE;
     }
 
-    // Read second argument.
-    __xdata uint8_t value;
-    if (serial_read_byte(&value) < 0) {
-        serial_write_byte(REPLY_TYPE_FAILED);
+    // Find command.
+    __data uint8_t group = l_payload[0] >> 4;
+    __data uint8_t index = l_payload[0] & 0x0F;
+    if (group >= COMMAND_GROUP_NUM || index >= l_command_group_size[group]) {
+        serial_reply_failed();
         return;
     }
+    __code struct CommandEntry *entry
+        = &l_commands[l_command_group_begin[group] + index];
 
-    // Parse second argument.
-    switch (value) {
-        case CMD_BEGIN: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            goto _PARSE_CMD;
-        }
-
-        case 0:
-        case 1: {
-            cmd_write_port(port, value);
-            break;
-        }
-
-        default: {
-            serial_write_byte(REPLY_TYPE_FAILED);
-            return;
-        }
+    // Check and handle.
+    if (l_payload_size != entry->size
+        || (entry->modes & MODE_MASK(current_mode())) == 0) {
+        serial_reply_failed();
+        return;
     }
-    return;
+    entry->handler();
 }
 
-_PARSE_CMD_GET_INPUT_SPEED : {
-    cmd_get_input_speed();
-    return;
-}
+/**
+ * @brief       Parse bytes received and handle commands.
+ */
+void serial_poll()
+{
+    // Drop the frame being received if the sender stalls.
+    if (l_rx_state != RX_STATE_BEGIN
+        && boot_time() - l_rx_byte_time > READ_TIMEOUT) {
+        l_rx_state = RX_STATE_BEGIN;
+    }
 
-_PARSE_CMD_GET_INPUT_PWM : {
-    serial_write_byte(REPLY_TYPE_FAILED);
-    return;
-}
+    if (l_rx_head == l_rx_tail) {
+        return;
+    }
 
-_PARSE_CMD_SET_OUTPUT_SPEED : {
-    serial_write_byte(REPLY_TYPE_FAILED);
-    return;
-}
+    while (l_rx_head != l_rx_tail) {
+        __data uint8_t byte = l_rx_ring[l_rx_head & (RX_RING_SIZE - 1)];
+        ++l_rx_head;
 
-_PARSE_CMD_SET_OUTPUT_PWM : {
-    serial_write_byte(REPLY_TYPE_FAILED);
-    return;
+        if (serial_parse_byte(byte)) {
+            serial_on_command();
+        }
+    }
+    l_rx_byte_time = boot_time();
 }
 
-_PARSE_CMD_READ_CONFIG : {
-    serial_write_byte(REPLY_TYPE_FAILED);
-    return;
+/**
+ * @brief       Check if serial is idle.
+ */
+bool serial_idle()
+{
+    return l_rx_state == RX_STATE_BEGIN && l_rx_head == l_rx_tail
+           && ! l_tx_busy && l_baud_rate_reload == 0
+           && l_link_check_state == LINK_CHECK_NONE
+           && boot_time() - l_rx_byte_time >= IDLE_TIMEOUT;
 }
 
-_PARSE_CMD_WRITE_CONFIG : {
-    serial_write_byte(REPLY_TYPE_FAILED);
-    return;
+/**
+ * @brief       Switch baud rate requested.
+ */
+void serial_switch_baud_rate()
+{
+    // Switch baud rate after the reply of SetBaudRate has been sent.
+    if (l_baud_rate_reload != 0 && ! l_tx_busy) {
+        serial_set_reload(l_baud_rate_reload);
+        l_baud_rate_reload      = 0;
+        l_link_check_state      = LINK_CHECK_WAITING;
+        l_link_check_begin_time = boot_time();
+    }
 }
 
-_PARSE_CMD_READ_CLOCK : {
-    cmd_read_clock();
-    return;
+/**
+ * @brief       Check the link after switching baud rate.
+ */
+void serial_check_link()
+{
+    if (l_link_check_state != LINK_CHECK_NONE
+        && boot_time() - l_link_check_begin_time > LINK_CHECK_TIMEOUT) {
+        // Not confirmed, fall back.
+        serial_set_reload(BAUD_RATE_RELOAD(SERIAL_DEFAULT_BAUD_RATE));
+        l_link_check_state = LINK_CHECK_NONE;
+    }
 }
+
+/**
+ * @brief       Push telemetry if subscribed.
+ */
+void serial_push_telemetry()
+{
+    if (l_telemetry_interval != 0
+        && boot_time() - l_telemetry_push_time
+               >= (uint32_t)l_telemetry_interval * 1000) {
+        __xdata struct ReplyGetTelemetry telemetry;
+        telemetry.header.replyType = REPLY_TYPE_SUCCESS;
+        telemetry.speed            = input_speed();
+        telemetry.dutyCycle        = input_pwm();
+        telemetry.frequency        = input_pwm_frequency();
+        telemetry.bootTime         = boot_time();
+        l_telemetry_push_time      = telemetry.bootTime;
+
+        serial_queue_frame(FRAME_SEQUENCE_PUSH, (uint8_t *)(&telemetry),
+                           (uint8_t)sizeof(telemetry));
+    }
 }
 
 /**
@@ -473,19 +821,22 @@ _PARSE_CMD_READ_CLOCK : {
 void serial_isr(void) __interrupt INT_UART1
 {
     if (SCON & 0x01) {
-        // Received.
-        // Disable interruption.
-        IE &= 0xEF;
-
-        // Handle command.
-        serial_on_command();
-
-        // Enable interruption.
-        IE |= 0x10;
+        // Received, the byte is dropped if the ring is full.
+        __data uint8_t byte = SBUF;
+        SCON &= 0xFE;
+        if ((uint8_t)(l_rx_tail - l_rx_head) < RX_RING_SIZE) {
+            l_rx_ring[l_rx_tail & (RX_RING_SIZE - 1)] = byte;
+            ++l_rx_tail;
+        }
     }
 
     if (SCON & 0x02) {
-        // Clear send status.
+        // Sent, send next byte.
         SCON &= 0xFD;
+        if (l_tx_head != l_tx_tail) {
+            UART_SEND(l_tx_ring[l_tx_head++]);
+        } else {
+            l_tx_busy = false;
+        }
     }
 }
@@ -1,17 +1,29 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
 
-#include <QtCore/QDateTime>
 #include <QtCore/QMetaEnum>
 #include <QtCore/QThread>
+#include <QtCore/QTimer>
 #include <QtSerialPort/QSerialPort>
 
 #include <command.h>
 
+#include <controller/command_statistics.h>
+#include <controller/command_traits.h>
+#include <controller/frame.h>
+#include <controller/serial_reader.h>
+#include <controller/trace.h>
 #include <locale/string_table.h>
 #include <serial/serial.h>
 
+Q_DECLARE_METATYPE(FirmwareConfig);
+
 /**
  * @brief       Board controller.
  */
@@ -22,11 +34,61 @@ class BoardController : public QThread {
     Q_ENUM(FirmwareMode);
     Q_ENUM(ReadablePort);
     Q_ENUM(WritablePort);
+    Q_ENUM(SpeedMethod);
+
+  private:
+    /**
+     * @brief       Reply handler.
+     *
+     * @param[in]   data    Reply received, \c nullptr if failed.
+     * @param[in]   size    Size of the reply, -1 if failed.
+     */
+    using ReplyHandler
+        = ::std::function<void(const uint8_t *data, qint64 size)>;
+
+    /**
+     * @brief       Command to send or waiting for reply.
+     */
+    struct PendingCommand {
+        ::std::vector<uint8_t> data;    ///< Command.
+        ReplyHandler           handler; ///< Reply handler.
+        ::std::chrono::steady_clock::time_point
+            sentTime; ///< Time when the command was sent.
+        ::std::chrono::steady_clock::time_point
+            deadline; ///< Deadline of the reply.
+        bool exclusive; ///< Sent only when no command is in flight.
+    };
+
+    /**
+     * @brief       Config transferred in chunks.
+     */
+    struct ConfigTransfer {
+        FirmwareConfig config;     ///< Config.
+        size_t         chunksLeft; ///< Chunks not acknowledged.
+        bool           failed;     ///< A chunk has run out of retries.
+        int commitRetries; ///< Times to resend all chunks if commit fails.
+    };
+
+    /// Retries of a config chunk before the transfer fails.
+    static constexpr int CONFIG_CHUNK_RETRIES = 3;
 
   private:
     StringTable *m_stringTable; ///< String table.
+    TraceLevel   m_traceLevel;  ///< Trace level.
 
-    Serial m_serialPort; ///< Serial port.
+    Serial       m_serialPort;   ///< Serial port.
+    quint32      m_baudRate;     ///< Baud rate.
+    SerialReader m_serialReader; ///< Serial reader.
+    uint8_t      m_sequence;     ///< Sequence of last command.
+    bool         m_linkHeld;     ///< Only exclusive commands sent if held.
+
+    ::std::deque<PendingCommand> m_waitingCommands; ///< Commands to send.
+    ::std::map<uint8_t, PendingCommand>
+        m_inFlightCommands; ///< Commands waiting for reply, key is sequence.
+
+    QTimer *m_timeoutTimer; ///< Timer to check the deadlines of replies.
+
+    CommandStatisticsMap m_statistics; ///< Statistics of commands.
 
   public:
     /**
@@ -53,20 +115,11 @@ class BoardController : public QThread {
     void closed();
 
     /**
-     * @brief       Infomation signal.
-     *
-     * @param[in]   time        Current time.
-     * @param[in]   message     Message.
-     */
-    void printInfo(QDateTime time, QString message);
-
-    /**
-     * @brief       Error signal.
+     * @brief       Trace signal.
      *
-     * @param[in]   time        Current time.
-     * @param[in]   message     Error message.
+     * @param[in]   record      Trace record.
      */
-    void printError(QDateTime time, QString message);
+    void traced(TraceRecord record);
 
     /**
      * @brief       Firmware mode signal.
@@ -77,18 +130,34 @@ class BoardController : public QThread {
     void firmwareModeUpdated(bool success, FirmwareMode mode);
 
     /**
-     * @brief       Firmware mode signal.
+     * @brief       Telemetry signal.
      *
-     * @param[in]   speed   Speed(HZ).
+     * @param[in]   speed       Input speed(HZ).
+     * @param[in]   dutyCycle   Input duty cycle, 0-100.
+     * @param[in]   frequency   Input PWM frequency(HZ), 0 if the level is
+     *                          constant.
+     * @param[in]   time        Boot time(microseconds).
      */
-    void speedUpdated(quint16 speed);
+    void telemetryUpdated(quint16 speed,
+                          quint8  dutyCycle,
+                          quint16 frequency,
+                          quint32 time);
 
     /**
-     * @brief       Firmware mode signal.
+     * @brief       Command statistics signal.
+     *
+     * @param[in]   statistics  Statistics of the commands sent.
+     */
+    void statisticsUpdated(CommandStatisticsMap statistics);
+
+    /**
+     * @brief       Baud rate signal.
      *
-     * @param[in]   time    Boot time(microseconds).
+     * @param[in]   success     \c true if the baud rate has been switched,
+     *                          \c false if fell back.
+     * @param[in]   baudRate    Current baud rate.
      */
-    void clockUpdated(quint32 time);
+    void baudRateUpdated(bool success, quint32 baudRate);
 
     /**
      * @brief       Port has been read.
@@ -98,7 +167,29 @@ class BoardController : public QThread {
      */
     void portRead(ReadablePort port, bool value);
 
+    /**
+     * @brief       Config has been read.
+     *
+     * @param[in]   success     Success flag.
+     * @param[in]   config      Config.
+     */
+    void configRead(bool success, FirmwareConfig config);
+
+    /**
+     * @brief       Config has been written.
+     *
+     * @param[in]   success     Success flag.
+     */
+    void configWritten(bool success);
+
   public slots:
+    /**
+     * @brief       Set trace level.
+     *
+     * @param[in]   level       Trace level.
+     */
+    void setTraceLevel(TraceLevel level);
+
     /**
      * @brief       Open serial.
      *
@@ -129,14 +220,39 @@ class BoardController : public QThread {
     void setFirmwareMode(FirmwareMode mode);
 
     /**
-     * @brief       Update fan speed.
+     * @brief       Subscribe telemetry pushed by firmware.
+     *
+     * @param[in]   interval    Min interval of pushes(ms), 0 to stop.
      */
-    void updateSpeed();
+    void subscribeTelemetry(quint16 interval);
 
     /**
-     * @brief       Update clock.
+     * @brief       Set the method to measure fan speed.
+     *
+     * @param[in]   method      Method.
      */
-    void updateClock();
+    void setSpeedMethod(SpeedMethod method);
+
+    /**
+     * @brief       Set the window to count pulses of fan speed.
+     *
+     * @param[in]   window      Window(ms), multiple of 50, 50-1000.
+     */
+    void setSpeedWindow(quint16 window);
+
+    /**
+     * @brief       Set output speed in manual mode.
+     *
+     * @param[in]   speed       Speed(HZ), 0 to stop.
+     */
+    void setOutputSpeed(quint16 speed);
+
+    /**
+     * @brief       Set output PWM in manual mode.
+     *
+     * @param[in]   dutyCycle   Duty cycle, 0-100.
+     */
+    void setOutputPWM(quint8 dutyCycle);
 
     /**
      * @brief       Read port.
@@ -153,24 +269,207 @@ class BoardController : public QThread {
      */
     void writedPort(WritablePort port, bool value);
 
+    /**
+     * @brief       Read config.
+     *
+     * The chunks are read in the window of commands in flight, a chunk
+     * failed is read again.
+     */
+    void readConfig();
+
+    /**
+     * @brief       Write config.
+     *
+     * The chunks are written in the window of commands in flight, a chunk
+     * failed is written again, then the config is committed.
+     *
+     * @param[in]   config      Config.
+     */
+    void writeConfig(FirmwareConfig config);
+
+    /**
+     * @brief       Set baud rate of both host and firmware.
+     *
+     * @param[in]   baudRate    Baud rate.
+     */
+    void setBaudRate(quint32 baudRate);
+
+    /**
+     * @brief       Update command statistics.
+     */
+    void updateStatistics();
+
+    /**
+     * @brief       Save command statistics as csv.
+     *
+     * @param[in]   fileName    Name of the file.
+     */
+    void saveStatistics(QString fileName);
+
+    /**
+     * @brief       Clear command statistics.
+     */
+    void clearStatistics();
+
+  private slots:
+    /**
+     * @brief       Dispatch frames decoded by serial reader.
+     */
+    void onFramesReceived();
+
+    /**
+     * @brief       Fail the commands whose reply is out of time.
+     */
+    void checkTimeouts();
+
   private:
+    /**
+     * @brief       Send command and handle its reply.
+     *
+     * The command type is set from the command traits, the reply is checked
+     * against the reply struct paired with the command before the handler is
+     * called. Failures are traced before \c onFailed is called.
+     *
+     * @tparam      Cmd         Command struct.
+     * @param[in]   command     Command.
+     * @param[in]   onSuccess   Called with the reply on success.
+     * @param[in]   onFailed    Called on failure.
+     * @param[in]   exclusive   Send only when no command is in flight.
+     */
+    template<typename Cmd>
+    void transact(
+        Cmd command,
+        ::std::function<void(const typename CommandTraits<Cmd>::Reply &)>
+                                onSuccess,
+        ::std::function<void()> onFailed  = nullptr,
+        bool                    exclusive = false);
+
+    /**
+     * @brief       Read a chunk of config.
+     *
+     * @param[in]   transfer    Transfer.
+     * @param[in]   offset      Offset of the chunk.
+     * @param[in]   retries     Retries left.
+     */
+    void readConfigChunk(::std::shared_ptr<ConfigTransfer> transfer,
+                         uint8_t                           offset,
+                         int                               retries);
+
+    /**
+     * @brief       Write a chunk of config.
+     *
+     * @param[in]   transfer    Transfer.
+     * @param[in]   offset      Offset of the chunk.
+     * @param[in]   retries     Retries left.
+     */
+    void writeConfigChunk(::std::shared_ptr<ConfigTransfer> transfer,
+                          uint8_t                           offset,
+                          int                               retries);
+
+    /**
+     * @brief       Write all chunks of config, committed after all chunks
+     *              are acknowledged.
+     *
+     * @param[in]   transfer    Transfer.
+     */
+    void writeConfigChunks(::std::shared_ptr<ConfigTransfer> transfer);
+
+    /**
+     * @brief       Commit config written, all chunks are written again if
+     *              failed, as the config staged by firmware is discarded.
+     *
+     * @param[in]   transfer    Transfer.
+     */
+    void commitConfig(::std::shared_ptr<ConfigTransfer> transfer);
+
     /**
      * @brief       Send command.
      *
-     * @param[in]   data    Data to send.
-     * @param[in]   size    Size of data.
+     * The command is sent as the payload of a frame with a new sequence
+     * number. At most FRAME_WINDOW_SIZE commands are in flight, the others
+     * are queued until a reply is received. An exclusive command waits until
+     * no command is in flight.
      *
-     * @return      Bytes sent, or -1 when failed.
+     * @param[in]   data        Data to send.
+     * @param[in]   size        Size of data.
+     * @param[in]   handler     Reply handler.
+     * @param[in]   exclusive   Send only when no command is in flight.
+     */
+    void sendCommand(const uint8_t *data,
+                     size_t         size,
+                     ReplyHandler   handler,
+                     bool           exclusive = false);
+
+    /**
+     * @brief       Send queued commands while the window is not full.
      */
-    qint64 sendCommand(const uint8_t *data, size_t size);
+    void sendWaitingCommands();
 
     /**
-     * @brief       Receive reply.
+     * @brief       Release the link held while switching baud rate, the
+     *              commands queued meanwhile are sent.
+     */
+    void releaseLink();
+
+    /**
+     * @brief       Fail all commands.
+     */
+    void failAllCommands();
+
+    /**
+     * @brief       Check the link after switching baud rate, falls back to
+     *              SERIAL_DEFAULT_BAUD_RATE on failure.
      *
-     * @param[out]  data    Data received.
-     * @param[in]   size    Size to receive.
+     * A frame is sent and, after its reply, a second frame confirms the link
+     * to the firmware. Each is retried until the deadline, which is later
+     * than the firmware falls back, so both sides end at the same baud rate.
+     *
+     * @param[in]   deadline    Deadline to confirm the link.
+     * @param[in]   confirming  \c true to send the confirming frame.
+     */
+    void checkLink(::std::chrono::steady_clock::time_point deadline,
+                   bool                                    confirming);
+
+    /**
+     * @brief       Ask firmware to restore the default baud rate before closing
+     *              the port.
+     */
+    void restoreDefaultBaudRate();
+
+    /**
+     * @brief       Handle telemetry pushed by firmware.
+     *
+     * @param[in]   frame       Frame received.
+     */
+    void onTelemetryPushed(const Frame &frame);
+
+    /**
+     * @brief       Start or stop the timer to check the deadlines of replies.
+     */
+    void updateTimeoutTimer();
+
+    /**
+     * @brief       Trace error message.
+     *
+     * @param[in]   stringId    String id of the message.
+     * @param[in]   args        Arguments of the message.
+     */
+    void traceError(const char *stringId, QStringList args = {});
+
+    /**
+     * @brief       Trace info message.
+     *
+     * @param[in]   stringId    String id of the message.
+     * @param[in]   args        Arguments of the message.
+     */
+    void traceInfo(const char *stringId, QStringList args = {});
+
+    /**
+     * @brief       Trace command sent or reply received.
      *
-     * @return      Bytes received, or -1 when failed.
+     * @param[in]   type        TraceType::Command or TraceType::Reply.
+     * @param[in]   data        Data.
+     * @param[in]   size        Size of data.
      */
-    qint64 receiveReply(uint8_t *data, size_t size);
+    void traceData(TraceType type, const uint8_t *data, size_t size);
 };
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <map>
+
+#include <QtCore/QMetaType>
+
+#include <command.h>
+
+#include <controller/latency_histogram.h>
+
+/**
+ * @brief       Statistics of a command type.
+ */
+struct CommandStatistics {
+    LatencyHistogram firstByteLatency; ///< Send to first byte of reply.
+    LatencyHistogram completeLatency;  ///< Send to last byte of reply.
+    quint64          timeouts    = 0;  ///< Replies out of time.
+    quint64          parseErrors = 0;  ///< Replies failed to parse.
+};
+
+/**
+ * @brief       Statistics of all command types sent.
+ */
+using CommandStatisticsMap = ::std::map<CMDType, CommandStatistics>;
+
+/**
+ * @brief       Get the name of a command type.
+ *
+ * @param[in]   type        Command type.
+ *
+ * @return      Name of the command type, "Unknown" if unknown.
+ */
+const char *commandName(CMDType type);
+
+Q_DECLARE_METATYPE(CommandStatisticsMap);
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include <command.h>
+
+/**
+ * @brief       Common part of command traits.
+ *
+ * @tparam      Cmd     Command struct.
+ * @tparam      Rep     Reply struct.
+ * @tparam      cmdType Command type.
+ */
+template<typename Cmd, typename Rep, CMDType cmdType>
+struct CommandTraitsBase {
+    static_assert(::std::is_trivially_copyable<Cmd>::value
+                      && ::std::is_trivially_copyable<Rep>::value,
+                  "Command and reply must be sent as raw bytes.");
+    static_assert(::std::is_same<decltype(Cmd::header), CMDHeader>::value
+                      && offsetof(Cmd, header) == 0,
+                  "Command must begin with a command header.");
+    static_assert(::std::is_same<decltype(Rep::header), ReplyHeader>::value
+                      && offsetof(Rep, header) == 0,
+                  "Reply must begin with a reply header.");
+    static_assert(sizeof(Cmd) <= FRAME_PAYLOAD_MAX_SIZE,
+                  "Command does not fit in a frame.");
+    static_assert(sizeof(Rep) <= FRAME_PAYLOAD_MAX_SIZE,
+                  "Reply does not fit in a frame.");
+
+    using Command = Cmd; ///< Command struct.
+    using Reply   = Rep; ///< Reply struct.
+
+    static constexpr CMDType type = cmdType; ///< Command type.
+
+    /**
+     * @brief       Check the content of a successful reply.
+     *
+     * @return      \c true if valid, otherwise returns \c false.
+     */
+    static bool isValid(const Reply &)
+    {
+        return true;
+    }
+};
+
+/**
+ * @brief       Command traits, pairs a command struct with its reply struct
+ *              and its command type. Only the commands specialized here can
+ *              be sent.
+ *
+ * @tparam      Cmd     Command struct.
+ */
+template<typename Cmd>
+struct CommandTraits;
+
+/**
+ * @brief       Command GetMode.
+ */
+template<>
+struct CommandTraits<CMDGetMode> :
+    CommandTraitsBase<CMDGetMode, ReplyGetMode, CMDType::GetMode> {
+    /**
+     * @brief       Check the mode replied.
+     */
+    static bool isValid(const ReplyGetMode &reply)
+    {
+        switch (reply.mode) {
+            case FirmwareMode::Normal:
+            case FirmwareMode::Manual:
+            case FirmwareMode::Test:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+};
+
+/**
+ * @brief       Command SetMode.
+ */
+template<>
+struct CommandTraits<CMDSetMode> :
+    CommandTraitsBase<CMDSetMode, ReplySetMode, CMDType::SetMode> {};
+
+/**
+ * @brief       Command ReadPort.
+ */
+template<>
+struct CommandTraits<CMDReadPort> :
+    CommandTraitsBase<CMDReadPort, ReplyReadPort, CMDType::ReadPort> {};
+
+/**
+ * @brief       Command WritePort.
+ */
+template<>
+struct CommandTraits<CMDWritePort> :
+    CommandTraitsBase<CMDWritePort, ReplyWritePort, CMDType::WritePort> {};
+
+/**
+ * @brief       Command GetInputSpeed.
+ */
+template<>
+struct CommandTraits<CMDGetInputSpeed> :
+    CommandTraitsBase<CMDGetInputSpeed,
+                      ReplyGetInputSpeed,
+                      CMDType::GetInputSpeed> {};
+
+/**
+ * @brief       Command GetInputPWM.
+ */
+template<>
+struct CommandTraits<CMDGetInputPWM> :
+    CommandTraitsBase<CMDGetInputPWM, ReplyGetInputPWM, CMDType::GetInputPWM> {
+};
+
+/**
+ * @brief       Command GetTelemetry.
+ */
+template<>
+struct CommandTraits<CMDGetTelemetry> :
+    CommandTraitsBase<CMDGetTelemetry,
+                      ReplyGetTelemetry,
+                      CMDType::GetTelemetry> {};
+
+/**
+ * @brief       Command SubscribeTelemetry.
+ */
+template<>
+struct CommandTraits<CMDSubscribeTelemetry> :
+    CommandTraitsBase<CMDSubscribeTelemetry,
+                      ReplySubscribeTelemetry,
+                      CMDType::SubscribeTelemetry> {};
+
+/**
+ * @brief       Command SetSpeedMethod.
+ */
+template<>
+struct CommandTraits<CMDSetSpeedMethod> :
+    CommandTraitsBase<CMDSetSpeedMethod,
+                      ReplySetSpeedMethod,
+                      CMDType::SetSpeedMethod> {};
+
+/**
+ * @brief       Command SetSpeedWindow.
+ */
+template<>
+struct CommandTraits<CMDSetSpeedWindow> :
+    CommandTraitsBase<CMDSetSpeedWindow,
+                      ReplySetSpeedWindow,
+                      CMDType::SetSpeedWindow> {};
+
+/**
+ * @brief       Command SetOutputSpeed.
+ */
+template<>
+struct CommandTraits<CMDSetOutputSpeed> :
+    CommandTraitsBase<CMDSetOutputSpeed,
+                      ReplySetOutputSpeed,
+                      CMDType::SetOutputSpeed> {};
+
+/**
+ * @brief       Command SetOutputPWM.
+ */
+template<>
+struct CommandTraits<CMDSetOutputPWM> :
+    CommandTraitsBase<CMDSetOutputPWM,
+                      ReplySetOutputPWM,
+                      CMDType::SetOutputPWM> {};
+
+/**
+ * @brief       Command ReadConfig.
+ */
+template<>
+struct CommandTraits<CMDReadConfig> :
+    CommandTraitsBase<CMDReadConfig, ReplyReadConfig, CMDType::ReadConfig> {
+    /**
+     * @brief       Check the range and crc of the chunk replied.
+     */
+    static bool isValid(const ReplyReadConfig &reply)
+    {
+        return reply.length <= CONFIG_CHUNK_MAX_SIZE
+               && reply.offset <= sizeof(FirmwareConfig)
+               && reply.length <= sizeof(FirmwareConfig) - reply.offset
+               && config_chunk_crc(reply.offset, reply.length, reply.data)
+                      == reply.crc;
+    }
+};
+
+/**
+ * @brief       Command WriteConfig.
+ */
+template<>
+struct CommandTraits<CMDWriteConfig> :
+    CommandTraitsBase<CMDWriteConfig, ReplyWriteConfig, CMDType::WriteConfig> {
+};
+
+/**
+ * @brief       Command CommitConfig.
+ */
+template<>
+struct CommandTraits<CMDCommitConfig> :
+    CommandTraitsBase<CMDCommitConfig,
+                      ReplyCommitConfig,
+                      CMDType::CommitConfig> {};
+
+/**
+ * @brief       Command ReadClock.
+ */
+template<>
+struct CommandTraits<CMDReadClock> :
+    CommandTraitsBase<CMDReadClock, ReplyReadClock, CMDType::ReadClock> {};
+
+/**
+ * @brief       Command SetBaudRate.
+ */
+template<>
+struct CommandTraits<CMDSetBaudRate> :
+    CommandTraitsBase<CMDSetBaudRate, ReplySetBaudRate, CMDType::SetBaudRate> {
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <command.h>
+
+/**
+ * @brief       Decoded frame.
+ */
+struct Frame {
+    uint8_t sequence;                        ///< Sequence number.
+    uint8_t length;                          ///< Size of payload.
+    uint8_t payload[FRAME_PAYLOAD_MAX_SIZE]; ///< Payload.
+    ::std::chrono::steady_clock::time_point
+        firstByteTime; ///< Time when the first byte was received.
+    ::std::chrono::steady_clock::time_point
+        completeTime; ///< Time when the last byte was received.
+};
+
+/**
+ * @brief       Encode frame.
+ *
+ * @param[in]   sequence    Sequence number.
+ * @param[in]   payload     Payload.
+ * @param[in]   size        Size of payload.
+ *
+ * @return      Encoded frame.
+ */
+::std::vector<uint8_t>
+    encodeFrame(uint8_t sequence, const void *payload, size_t size);
+
+/**
+ * @brief       Frame decoder.
+ *
+ * Bytes received are pushed into the decoder, the decoder looks for the
+ * beginning of a frame and checks the length and the crc of it. On a bad
+ * frame, only the beginning byte is dropped, so the decoder resyncs on the
+ * next beginning byte without discarding the following frames.
+ *
+ * The time when each byte is pushed is kept to timestamp the frames decoded.
+ * Like the firmware, bytes not decoded are dropped when no byte has been
+ * received for BYTE_TIMEOUT, so a stray beginning byte cannot swallow the
+ * following frames.
+ */
+class FrameDecoder {
+  public:
+    static constexpr ::std::chrono::milliseconds BYTE_TIMEOUT {
+        100}; ///< Max time between bytes of a frame.
+
+  private:
+    ::std::vector<uint8_t> m_buffer; ///< Bytes not decoded.
+    ::std::vector<::std::chrono::steady_clock::time_point>
+        m_times; ///< Time when each byte not decoded was received.
+
+  public:
+    /**
+     * @brief       Constructor.
+     */
+    FrameDecoder();
+
+    /**
+     * @brief       Push bytes received.
+     *
+     * Bytes not decoded are dropped first if the last of them was received
+     * more than BYTE_TIMEOUT before \a time.
+     *
+     * @param[in]   data    Data received.
+     * @param[in]   size    Size of data.
+     * @param[in]   time    Time when the data was received.
+     */
+    void push(const uint8_t                          *data,
+              size_t                                  size,
+              ::std::chrono::steady_clock::time_point time
+              = ::std::chrono::steady_clock::now());
+
+    /**
+     * @brief       Pop next frame.
+     *
+     * @param[out]  frame       Frame decoded.
+     *
+     * @return      \c true if a frame has been decoded, otherwise returns
+     *              \c false.
+     */
+    bool pop(Frame &frame);
+
+    /**
+     * @brief       Drop all bytes.
+     */
+    void clear();
+
+    /**
+     * @brief       Destructor.
+     */
+    virtual ~FrameDecoder();
+};
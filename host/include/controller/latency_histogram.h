@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief       Latency histogram.
+ *
+ * Latencies are counted in microseconds with fixed log-linear buckets, the
+ * values below 2 * SUB_BUCKET_COUNT have a bucket each, each power of two
+ * above is split into SUB_BUCKET_COUNT buckets, so the relative error of a
+ * bucket is below 1 / SUB_BUCKET_COUNT. Latencies above MAX_VALUE are counted
+ * in the last bucket.
+ */
+class LatencyHistogram {
+  public:
+    static constexpr size_t   SUB_BUCKET_BITS  = 4; ///< Bits of sub bucket.
+    static constexpr size_t   SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr size_t   MAX_VALUE_BITS   = 26; ///< About 67s.
+    static constexpr uint64_t MAX_VALUE = (UINT64_C(1) << MAX_VALUE_BITS) - 1;
+    static constexpr size_t   BUCKET_COUNT
+        = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+  private:
+    ::std::array<uint64_t, BUCKET_COUNT> m_buckets; ///< Buckets.
+    uint64_t                             m_count;   ///< Number of values.
+    uint64_t                             m_sum;     ///< Sum of values.
+    uint64_t                             m_min;     ///< Min value.
+    uint64_t                             m_max;     ///< Max value.
+
+  public:
+    /**
+     * @brief       Constructor.
+     */
+    LatencyHistogram();
+
+    /**
+     * @brief       Record latency.
+     *
+     * @param[in]   latency     Latency.
+     */
+    void record(::std::chrono::steady_clock::duration latency);
+
+    /**
+     * @brief       Drop all values.
+     */
+    void clear();
+
+    /**
+     * @brief       Get the number of values.
+     *
+     * @return      Number of values.
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief       Get min value(us).
+     *
+     * @return      Min value, 0 if empty.
+     */
+    uint64_t min() const;
+
+    /**
+     * @brief       Get max value(us).
+     *
+     * @return      Max value, 0 if empty.
+     */
+    uint64_t max() const;
+
+    /**
+     * @brief       Get mean value(us).
+     *
+     * @return      Mean value, 0 if empty.
+     */
+    uint64_t mean() const;
+
+    /**
+     * @brief       Get percentile(us).
+     *
+     * @param[in]   percentile      Percentile, 0-100.
+     *
+     * @return      Upper bound of the bucket where the percentile is, 0 if
+     *              empty.
+     */
+    uint64_t percentile(double percentile) const;
+
+    /**
+     * @brief       Get the number of values in bucket.
+     *
+     * @param[in]   index       Index of bucket.
+     *
+     * @return      Number of values.
+     */
+    uint64_t bucketCount(size_t index) const;
+
+    /**
+     * @brief       Get the lower bound of bucket(us).
+     *
+     * @param[in]   index       Index of bucket.
+     *
+     * @return      Min value in the bucket.
+     */
+    static uint64_t bucketLowerBound(size_t index);
+
+    /**
+     * @brief       Get the upper bound of bucket(us).
+     *
+     * @param[in]   index       Index of bucket.
+     *
+     * @return      Max value in the bucket.
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+    /**
+     * @brief       Destructor.
+     */
+    virtual ~LatencyHistogram();
+
+  private:
+    /**
+     * @brief       Get the index of the bucket of value.
+     *
+     * @param[in]   value       Value(us).
+     *
+     * @return      Index of bucket.
+     */
+    static size_t bucketIndex(uint64_t value);
+};
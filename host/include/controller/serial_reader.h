@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+#include <QtCore/QThread>
+
+#include <controller/frame.h>
+#include <controller/spsc_ring.h>
+#include <serial/serial.h>
+
+/**
+ * @brief       Serial reader.
+ *
+ * The reader thread drains the port, decodes frames and pushes them into a
+ * lock-free ring. The consumer is notified once for a batch of frames, it
+ * must call acknowledge() before popping the frames so that frames pushed
+ * meanwhile trigger a new notification.
+ */
+class SerialReader : public QThread {
+  private:
+    Serial *                m_serial;        ///< Serial port.
+    ::std::function<void()> m_notify;        ///< Called when frames pushed.
+    FrameDecoder            m_frameDecoder;  ///< Frame decoder.
+    SPSCRing<Frame, 64>     m_frames;        ///< Frames decoded.
+    ::std::atomic<bool>     m_stop;          ///< Stop flag.
+    ::std::atomic<bool>     m_failed;        ///< Read failed.
+    ::std::atomic<bool>     m_notifyPending; ///< Notified, not acknowledged.
+
+  public:
+    /**
+     * @brief       Constructor.
+     *
+     * @param[in]   serial      Serial port to read.
+     * @param[in]   notify      Called in reader thread when frames have been
+     *                          decoded or the read failed.
+     */
+    SerialReader(Serial *serial, ::std::function<void()> notify);
+
+    /**
+     * @brief       Start reading, the port must have been opened.
+     */
+    void startReading();
+
+    /**
+     * @brief       Stop reading and wait for the reader thread.
+     */
+    void stopReading();
+
+    /**
+     * @brief       Acknowledge the notification, consumer only.
+     */
+    void acknowledge();
+
+    /**
+     * @brief       Pop frame decoded, consumer only.
+     *
+     * @param[out]  frame       Frame.
+     *
+     * @return      \c true if a frame has been popped, otherwise returns
+     *              \c false.
+     */
+    bool popFrame(Frame &frame);
+
+    /**
+     * @brief       Check if the read failed, the reader thread exits after a
+     *              failure.
+     *
+     * @return      \c true if failed, otherwise returns \c false.
+     */
+    bool failed() const;
+
+    /**
+     * @brief       Destructor.
+     */
+    virtual ~SerialReader();
+
+  protected:
+    /**
+     * @brief       Thread entry.
+     */
+    virtual void run() override;
+
+  private:
+    /**
+     * @brief       Notify the consumer if not notified.
+     */
+    void notify();
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief       Lock-free single-producer/single-consumer ring buffer.
+ *
+ * One thread pushes and one thread pops, neither of them blocks. The head is
+ * written by the consumer only and the tail by the producer only, an item is
+ * published to the consumer by the release store of the tail.
+ *
+ * @tparam      T           Type of items.
+ * @tparam      Capacity    Max number of items, must be a power of 2.
+ */
+template<typename T, size_t Capacity>
+class SPSCRing {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of 2.");
+
+  private:
+    T m_items[Capacity]; ///< Items.
+
+    alignas(64) ::std::atomic<size_t> m_head; ///< Next item to pop.
+    alignas(64) ::std::atomic<size_t> m_tail; ///< Next item to push.
+
+  public:
+    /**
+     * @brief       Constructor.
+     */
+    SPSCRing() : m_head(0), m_tail(0) {}
+    SPSCRing(const SPSCRing &) = delete;
+    SPSCRing(SPSCRing &&)      = delete;
+
+    /**
+     * @brief       Push item, producer only.
+     *
+     * @param[in]   item        Item to push.
+     *
+     * @return      \c true if success, \c false if the ring is full.
+     */
+    bool push(const T &item)
+    {
+        size_t tail = m_tail.load(::std::memory_order_relaxed);
+        if (tail - m_head.load(::std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.store(tail + 1, ::std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief       Pop item, consumer only.
+     *
+     * @param[out]  item        Item popped.
+     *
+     * @return      \c true if success, \c false if the ring is empty.
+     */
+    bool pop(T &item)
+    {
+        size_t head = m_head.load(::std::memory_order_relaxed);
+        if (head == m_tail.load(::std::memory_order_acquire)) {
+            return false;
+        }
+
+        item = m_items[head & (Capacity - 1)];
+        m_head.store(head + 1, ::std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief       Drop all items, neither the producer nor the consumer may
+     *              be running.
+     */
+    void clear()
+    {
+        m_head.store(0, ::std::memory_order_relaxed);
+        m_tail.store(0, ::std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief       Destructor.
+     */
+    virtual ~SPSCRing() {}
+};
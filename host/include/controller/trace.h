@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QMetaType>
+#include <QtCore/QStringList>
+
+/**
+ * @brief       Trace level, each level includes the levels below.
+ */
+enum class TraceLevel : quint8 {
+    Off     = 0, ///< Nothing traced.
+    Errors  = 1, ///< Errors only.
+    Summary = 2, ///< Messages.
+    Verbose = 3, ///< Messages of each command, command and reply types.
+    Hex     = 4  ///< Messages, commands and replies in hex.
+};
+
+/**
+ * @brief       Type of trace record.
+ */
+enum class TraceType : quint8 {
+    Error,   ///< Error message.
+    Info,    ///< Info message.
+    Command, ///< Command sent.
+    Reply    ///< Reply received.
+};
+
+/**
+ * @brief       Trace record.
+ *
+ * Only the raw data is captured when tracing, the string shown is built by
+ * the sink which renders the record.
+ */
+struct TraceRecord {
+    ::std::chrono::steady_clock::time_point time;  ///< Monotonic time.
+    TraceType                               type;  ///< Type.
+    TraceLevel                              level; ///< Level when captured.
+    const char *stringId; ///< Message string id, message records only.
+    QStringList args;     ///< Message arguments, message records only.
+    quint8      dataType; ///< First byte of data, command or reply type.
+    size_t      size;     ///< Size of data.
+    QByteArray  data;     ///< Data in hex level, command and reply only.
+};
+
+Q_DECLARE_METATYPE(TraceLevel);
+Q_DECLARE_METATYPE(TraceRecord);
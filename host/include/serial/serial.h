@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include <QtCore/QString>
 
@@ -28,9 +29,18 @@ class Serial {
     using NativeHandle = int;
 
 #endif
+
+    /// Baud rates supported on all platforms.
+    static constexpr uint32_t BAUD_RATES[] = {9600, 19200, 38400, 57600,
+                                              115200};
+
   private:
     QString      m_name;         ///< Device name.
     NativeHandle m_nativeHandle; ///< Native handle.
+#if defined(OS_LINUX)
+    int                    m_epollFd;    ///< Epoll fd, the port is registered.
+    ::std::vector<uint8_t> m_readBuffer; ///< Bytes read but not consumed.
+#endif
 
   public:
     /**
@@ -56,6 +66,24 @@ class Serial {
      */
     bool open(const QString &name);
 
+    /**
+     * @brief       Set baud rate.
+     *
+     * @param[in]   baudRate    Baud rate.
+     *
+     * @return      \c true if succcess, otherwise returns false.
+     */
+    bool setBaudRate(uint32_t baudRate);
+
+    /**
+     * @brief       Check if the baud rate is in BAUD_RATES.
+     *
+     * @param[in]   baudRate    Baud rate.
+     *
+     * @return      \c true if supported, otherwise returns false.
+     */
+    static bool isBaudRateSupported(uint32_t baudRate);
+
     /**
      * @nrief       Get device name.
      *
@@ -81,6 +109,37 @@ class Serial {
     ssize_t
         read(void *buffer, size_t size, ::std::chrono::milliseconds timeout);
 
+    /**
+     * @brief       Get the number of bytes which can be read without
+     *              blocking.
+     *
+     * @return      On success, the numbner of bytes available returned,
+     *              otherwise returns -1.
+     */
+    ssize_t available();
+
+    /**
+     * @brief       Wait until there are bytes to read.
+     *
+     * @param[in]   timeout     Timeout.
+     *
+     * @return      \c true if there are bytes to read or the port has hung
+     *              up, so the read following reports the failure,
+     *              otherwise returns \c false.
+     */
+    bool waitForReadyRead(::std::chrono::milliseconds timeout);
+
+    /**
+     * @brief       Read bytes available without blocking.
+     *
+     * @param[out]  buffer      Output buffer.
+     * @param[in]   size        Size of buffer.
+     *
+     * @return      On success, the numbner of bytes read returned, 0 if no
+     *              data available, otherwise returns -1.
+     */
+    ssize_t readAvailable(void *buffer, size_t size);
+
     /**
      * @brief       Write bytes.
      *
@@ -101,4 +160,14 @@ class Serial {
      * @brief       Destructor.
      */
     virtual ~Serial();
+
+#if defined(OS_LINUX)
+  private:
+    /**
+     * @brief       Read all bytes available into read buffer.
+     *
+     * @return      \c true if success, otherwise returns \c false.
+     */
+    bool fillReadBuffer();
+#endif
 };
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <QtWidgets/QComboBox>
 #include <QtWidgets/QLineEdit>
 #include <QtWidgets/QPushButton>
+#include <QtWidgets/QSpinBox>
 
 #include <controller/board_controller.h>
 #include <locale/string_table.h>
@@ -25,9 +27,17 @@ class GenericOperationWidget : public QWidget {
         *      m_btnStartStopGetBootTime; ///< Button start/stop get boot time.
     QLineEdit *m_txtBootTime;             ///< Text to show boot time.
 
-    QTimer *m_updateTimer;    ///< Update timer.
-    bool    m_updateSpeed;    ///< Update speed.
-    bool    m_updateBootTime; ///< Update boot time.
+    QPushButton
+        *      m_btnStartStopGetPWM; ///< Button start/stop get input PWM.
+    QLineEdit *m_txtPWMDutyCycle;    ///< Input PWM duty cycle.
+    QLineEdit *m_txtPWMFrequency;    ///< Input PWM frequency.
+
+    QComboBox *m_comboSpeedMethod; ///< Method to measure fan speed.
+    QSpinBox * m_spinSpeedWindow;  ///< Window to count pulses(ms).
+
+    bool m_updateSpeed;    ///< Update speed.
+    bool m_updateBootTime; ///< Update boot time.
+    bool m_updatePWM;      ///< Update input PWM.
 
   public:
     /**
@@ -48,14 +58,25 @@ class GenericOperationWidget : public QWidget {
 
   signals:
     /**
-     * @brief       Update fan speed.
+     * @brief       Subscribe telemetry pushed by firmware.
+     *
+     * @param[in]   interval    Min interval of pushes(ms), 0 to stop.
+     */
+    void subscribeTelemetry(quint16 interval);
+
+    /**
+     * @brief       Set the method to measure fan speed.
+     *
+     * @param[in]   method      Method.
      */
-    void updateSpeed();
+    void setSpeedMethod(SpeedMethod method);
 
     /**
-     * @brief       Update clock.
+     * @brief       Set the window to count pulses of fan speed.
+     *
+     * @param[in]   window      Window(ms).
      */
-    void updateClock();
+    void setSpeedWindow(quint16 window);
 
   private slots:
     /**
@@ -89,21 +110,46 @@ class GenericOperationWidget : public QWidget {
     void onBtnStopGetBootTimeClicked();
 
     /**
-     * @brief       On timer.
+     * @brief       On button start get input PWM clicked.
+     */
+    void onBtnStartGetPWMClicked();
+
+    /**
+     * @brief       On button stop get input PWM clicked.
+     */
+    void onBtnStopGetPWMClicked();
+
+    /**
+     * @brief       On speed method changed.
+     *
+     * @param[in]   index       Index of the method.
      */
-    void onTimer();
+    void onSpeedMethodChanged(int index);
 
     /**
-     * @brief       Firmware mode signal.
+     * @brief       On speed window changed.
      *
-     * @param[in]   speed   Speed(HZ).
+     * @param[in]   window      Window(ms).
      */
-    void onSpeedUpdated(quint16 speed);
+    void onSpeedWindowChanged(int window);
 
     /**
-     * @brief       Firmware mode signal.
+     * @brief       Telemetry signal.
      *
-     * @param[in]   time    Boot time(microseconds).
+     * @param[in]   speed       Input speed(HZ).
+     * @param[in]   dutyCycle   Input duty cycle, 0-100.
+     * @param[in]   frequency   Input PWM frequency(HZ).
+     * @param[in]   time        Boot time(microseconds).
+     */
+    void onTelemetryUpdated(quint16 speed,
+                            quint8  dutyCycle,
+                            quint16 frequency,
+                            quint32 time);
+
+  private:
+    /**
+     * @brief       Subscribe telemetry if speed, boot time or input PWM is
+     *              being read, otherwise unsubscribe.
      */
-    void onClockUpdated(quint32 time);
+    void updateSubscription();
 };
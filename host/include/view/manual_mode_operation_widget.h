@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QSpinBox>
 #include <QtWidgets/QWidget>
 
 #include <controller/board_controller.h>
@@ -15,6 +17,12 @@ class ManualModeWidget : public QWidget {
     BoardController *m_boardController; ///< Board controller.
     StringTable *    m_stringTable;     ///< String table.
 
+    QSpinBox *   m_spinOutputSpeed;   ///< Output speed.
+    QPushButton *m_btnSetOutputSpeed; ///< Button to set output speed.
+
+    QSpinBox *   m_spinOutputPWM;   ///< Output PWM duty cycle.
+    QPushButton *m_btnSetOutputPWM; ///< Button to set output PWM.
+
   public:
     /**
      * @brief       Constructor.
@@ -32,6 +40,21 @@ class ManualModeWidget : public QWidget {
      */
     virtual ~ManualModeWidget();
 
+  signals:
+    /**
+     * @brief       Set output speed.
+     *
+     * @param[in]   speed       Speed(HZ).
+     */
+    void setOutputSpeed(quint16 speed);
+
+    /**
+     * @brief       Set output PWM.
+     *
+     * @param[in]   dutyCycle   Duty cycle, 0-100.
+     */
+    void setOutputPWM(quint8 dutyCycle);
+
   private slots:
     /**
      * @brief       Opened slots.
@@ -43,6 +66,16 @@ class ManualModeWidget : public QWidget {
      */
     void onClosed();
 
+    /**
+     * @brief       On button set output speed clicked.
+     */
+    void onBtnSetOutputSpeedClicked();
+
+    /**
+     * @brief       On button set output PWM clicked.
+     */
+    void onBtnSetOutputPWMClicked();
+
     /**
      * @brief       Firmware mode updated.
      *
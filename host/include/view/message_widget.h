@@ -1,8 +1,12 @@
 #pragma once
 
+#include <chrono>
+
 #include <QtCore/QDateTime>
+#include <QtWidgets/QComboBox>
 #include <QtWidgets/QTextEdit>
 
+#include <controller/trace.h>
 #include <locale/string_table.h>
 
 /**
@@ -14,7 +18,12 @@ class MessageWidget : public QWidget {
   private:
     StringTable *m_stringTable; ///< String table.
 
-    QTextEdit *m_textEdit; ///< Text edit.
+    QComboBox *m_comboTraceLevel; ///< Trace level.
+    QTextEdit *m_textEdit;        ///< Text edit.
+
+    QDateTime m_baseTime; ///< Wall time when the widget is created.
+    ::std::chrono::steady_clock::time_point
+        m_baseSteadyTime; ///< Monotonic time when the widget is created.
 
   public:
     /**
@@ -30,6 +39,21 @@ class MessageWidget : public QWidget {
      */
     virtual ~MessageWidget();
 
+  signals:
+    /**
+     * @brief       Trace level changed signal.
+     *
+     * @param[in]   level       Trace level.
+     */
+    void traceLevelChanged(TraceLevel level);
+
+    /**
+     * @brief       Save command statistics signal.
+     *
+     * @param[in]   fileName    Name of the file.
+     */
+    void saveStatistics(QString fileName);
+
   public slots:
     /**
      * @brief       On button clear clicked.
@@ -37,18 +61,21 @@ class MessageWidget : public QWidget {
     void onBtnClearClicked();
 
     /**
-     * @brief       Print info message.
+     * @brief       On button save statistics clicked.
+     */
+    void onBtnSaveStatisticsClicked();
+
+    /**
+     * @brief       On trace level changed.
      *
-     * @param[in]   time        Current time.
-     * @param[in]   message     Message.
+     * @param[in]   index       Index of the trace level selected.
      */
-    void onPrintInfo(QDateTime time, QString message);
+    void onTraceLevelChanged(int index);
 
     /**
-     * @brief       Print error message.
+     * @brief       Print trace record.
      *
-     * @param[in]   time        Current time.
-     * @param[in]   message     Message.
+     * @param[in]   record      Trace record.
      */
-    void onPrintError(QDateTime time, QString message);
+    void onTraced(TraceRecord record);
 };
@@ -20,6 +20,9 @@ class SerialWidget : public QWidget {
     QPushButton *m_btnOpenClose; ///< Button open/close.
     QPushButton *m_btnRefresh;   ///< Button refresh.
 
+    QComboBox *  m_comboBaudRate;  ///< Combobox to select baud rate.
+    QPushButton *m_btnSetBaudRate; ///< Button set baud rate.
+
     StringTable *m_stringTable; ///< String table.
 
   public:
@@ -52,6 +55,13 @@ class SerialWidget : public QWidget {
      */
     void close();
 
+    /**
+     * @brief       Set baud rate.
+     *
+     * @param[in]   baudRate    Baud rate.
+     */
+    void setBaudRate(quint32 baudRate);
+
   private slots:
     /**
      * @brief       Opened slots.
@@ -77,4 +87,17 @@ class SerialWidget : public QWidget {
      * @brief       On button refresh clicked.
      */
     void onBtnRefreshClicked();
+
+    /**
+     * @brief       On button set baud rate clicked.
+     */
+    void onBtnSetBaudRateClicked();
+
+    /**
+     * @brief       Baud rate updated.
+     *
+     * @param[in]   success     Success flag.
+     * @param[in]   baudRate    Current baud rate.
+     */
+    void onBaudRateUpdated(bool success, quint32 baudRate);
 };
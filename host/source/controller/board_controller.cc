@@ -1,20 +1,127 @@
+#include <algorithm>
 #include <chrono>
 
 #include <QtCore/QDebug>
+#include <QtCore/QFile>
 #include <QtCore/QMetaType>
+#include <QtCore/QTextStream>
 
 #include <controller/board_controller.h>
 #include <utils/utils.h>
 
+/**
+ * @brief       Send command and handle its reply.
+ */
+template<typename Cmd>
+void BoardController::transact(
+    Cmd command,
+    ::std::function<void(const typename CommandTraits<Cmd>::Reply &)>
+                            onSuccess,
+    ::std::function<void()> onFailed,
+    bool                    exclusive)
+{
+    using Traits = CommandTraits<Cmd>;
+    using Reply  = typename Traits::Reply;
+
+    // Called when failed.
+    auto fail = [this, onFailed](bool parseError) -> void {
+        if (parseError) {
+            ++m_statistics[Traits::type].parseErrors;
+            this->traceError("STR_MESSAGE_REPLY_PARSE_ERROR");
+        }
+        this->traceError("STR_MESSAGE_OPERATION_FAILED");
+        if (onFailed) {
+            onFailed();
+        }
+    };
+
+    if (! m_serialPort.isOpened()) {
+        fail(false);
+        return;
+    }
+
+    // Send command.
+    command.header.cmdType = Traits::type;
+    this->sendCommand(
+        reinterpret_cast<const uint8_t *>(&command), sizeof(command),
+        [this, onSuccess, fail](const uint8_t *data, qint64 size) -> void {
+            if (size < 0) {
+                fail(false);
+                return;
+            }
+            if (static_cast<size_t>(size) < sizeof(ReplyHeader)) {
+                fail(true);
+                return;
+            }
+
+            // Parse reply.
+            ReplyHeader header;
+            ::std::copy(data, data + sizeof(header),
+                        reinterpret_cast<uint8_t *>(&header));
+            switch (header.replyType) {
+                case ReplyType::Success:
+                    break;
+
+                case ReplyType::Failed:
+                    fail(false);
+                    return;
+
+                default:
+                    fail(true);
+                    return;
+            }
+
+            Reply reply;
+            if (static_cast<size_t>(size) != sizeof(reply)) {
+                fail(true);
+                return;
+            }
+            ::std::copy(data, data + sizeof(reply),
+                        reinterpret_cast<uint8_t *>(&reply));
+            if (! Traits::isValid(reply)) {
+                fail(true);
+                return;
+            }
+
+            if (m_traceLevel >= TraceLevel::Verbose) {
+                this->traceInfo("STR_MESSAGE_OPERATION_SUCCEED");
+            }
+            onSuccess(reply);
+        },
+        exclusive);
+}
+
 /**
  * @brief       Constructor.
  */
 BoardController::BoardController(StringTable *stringTable) :
-    QThread(nullptr), m_stringTable(stringTable)
+    QThread(nullptr), m_stringTable(stringTable),
+    m_traceLevel(TraceLevel::Summary), m_baudRate(SERIAL_DEFAULT_BAUD_RATE),
+    m_serialReader(&m_serialPort,
+                   [this]() -> void {
+                       QMetaObject::invokeMethod(
+                           this,
+                           [this]() -> void {
+                               this->onFramesReceived();
+                           },
+                           Qt::QueuedConnection);
+                   }),
+    m_sequence(0), m_linkHeld(false)
 {
     qRegisterMetaType<FirmwareMode>("FirmwareMode");
     qRegisterMetaType<ReadablePort>("ReadablePort");
     qRegisterMetaType<WritablePort>("WritablePort");
+    qRegisterMetaType<TraceLevel>("TraceLevel");
+    qRegisterMetaType<TraceRecord>("TraceRecord");
+    qRegisterMetaType<CommandStatisticsMap>("CommandStatisticsMap");
+    qRegisterMetaType<FirmwareConfig>("FirmwareConfig");
+
+    m_timeoutTimer = new QTimer(this);
+    m_timeoutTimer->setInterval(10);
+    m_timeoutTimer->setSingleShot(false);
+    this->connect(m_timeoutTimer, &QTimer::timeout, this,
+                  &BoardController::checkTimeouts);
+
     this->moveToThread(this);
 }
 
@@ -29,21 +136,24 @@ BoardController::~BoardController() {}
 void BoardController::open(QString name)
 {
     if (m_serialPort.isOpened()) {
+        this->restoreDefaultBaudRate();
+        m_serialReader.stopReading();
         m_serialPort.close();
+        this->failAllCommands();
     }
 
     // Open port.
+    m_linkHeld = false;
     if (m_serialPort.open(name)) {
+        m_baudRate = SERIAL_DEFAULT_BAUD_RATE;
+        m_serialPort.clearRead();
+        m_serialReader.startReading();
         qDebug() << "Port" << name << "opened.";
-        emit this->printInfo(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_PORT_OPENED").arg(name));
+        this->traceInfo("STR_MESSAGE_PORT_OPENED", {name});
         this->updateOpenStatus();
     } else {
         qDebug() << "Failed to open port" << name << ".";
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_PORT_OPEN_FAILED").arg(name));
+        this->traceError("STR_MESSAGE_PORT_OPEN_FAILED", {name});
         m_serialPort.close();
         this->updateOpenStatus();
     }
@@ -56,11 +166,12 @@ void BoardController::close()
 {
     if (m_serialPort.isOpened()) {
         QString name = m_serialPort.name();
+        this->restoreDefaultBaudRate();
+        m_serialReader.stopReading();
         m_serialPort.clearRead();
         m_serialPort.close();
-        emit this->printInfo(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_PORT_CLOSED").arg(name));
+        this->failAllCommands();
+        this->traceInfo("STR_MESSAGE_PORT_CLOSED", {name});
         this->updateOpenStatus();
     }
 }
@@ -77,658 +188,739 @@ void BoardController::updateOpenStatus()
     }
 }
 
+/**
+ * @brief       Set trace level.
+ */
+void BoardController::setTraceLevel(TraceLevel level)
+{
+    m_traceLevel = level;
+}
+
 /**
  * @brief       Update firmware mode.
  */
 void BoardController::updateFirmwareMode()
 {
-    if (! m_serialPort.isOpened()) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
-    m_serialPort.clearRead();
-
-    // Send command.
     CMDGetMode command;
-    command.header.cmdBegin = CMD_BEGIN;
-    command.header.cmdType  = CMDType::GetMode;
-
-    if (this->sendCommand(reinterpret_cast<const uint8_t *>(&command),
-                          sizeof(command))
-        < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_COMMAND_SEND_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        emit this->firmwareModeUpdated(false, FirmwareMode::Normal);
-        return;
-    }
-
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_COMMAND_SEND")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&command), sizeof(command))
-                    .toHex(' ')
-                    .toUpper())));
-
-    // Get reply.
-    ReplyGetMode reply;
-    uint8_t *    pReply = reinterpret_cast<uint8_t *>(&reply);
-
-    // Receive first byte.
-    if (this->receiveReply(pReply, sizeof(uint8_t)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        emit this->firmwareModeUpdated(false, FirmwareMode::Normal);
-        return;
-    }
-    switch (reply.header.replyType) {
-        case ReplyType::Success:
-            break;
-
-        case ReplyType::Failed:
-            emit this->printInfo(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY")
-                    .arg(QString::fromUtf8(
-                        QByteArray(reinterpret_cast<char *>(pReply),
-                                   sizeof(uint8_t))
-                            .toHex(' ')
-                            .toUpper())));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
+    this->transact(
+        command,
+        [this](const ReplyGetMode &reply) -> void {
+            emit this->firmwareModeUpdated(true, reply.mode);
+        },
+        [this]() -> void {
             emit this->firmwareModeUpdated(false, FirmwareMode::Normal);
-            return;
+        });
+}
 
-        default:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY_PARSE_ERROR"));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            emit this->firmwareModeUpdated(false, FirmwareMode::Normal);
-            return;
-    }
+/**
+ * @brief       Set firmware mode.
+ */
+void BoardController::setFirmwareMode(FirmwareMode mode)
+{
+    CMDSetMode command;
+    command.mode = mode;
+    this->transact(command, [](const ReplySetMode &) -> void {});
+}
 
-    // Receive remaining data,
-    if (this->receiveReply(pReply + 1, sizeof(reply) - sizeof(uint8_t)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        emit this->firmwareModeUpdated(false, FirmwareMode::Normal);
-        return;
-    }
+/**
+ * @brief       Subscribe telemetry pushed by firmware.
+ */
+void BoardController::subscribeTelemetry(quint16 interval)
+{
+    CMDSubscribeTelemetry command;
+    command.interval = interval;
+    this->transact(command, [](const ReplySubscribeTelemetry &) -> void {});
+}
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_REPLY")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&reply), sizeof(reply))
-                    .toHex(' ')
-                    .toUpper())));
-    // Parse type.
-    switch (reply.mode) {
-        case FirmwareMode::Normal:
-        case FirmwareMode::Manual:
-        case FirmwareMode::Test:
-            emit this->printInfo(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_SUCCEED"));
-            emit this->firmwareModeUpdated(true, reply.mode);
-            return;
+/**
+ * @brief       Set the method to measure fan speed.
+ */
+void BoardController::setSpeedMethod(SpeedMethod method)
+{
+    CMDSetSpeedMethod command;
+    command.method = method;
+    this->transact(command, [](const ReplySetSpeedMethod &) -> void {});
+}
 
-        default:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY_PARSE_ERROR"));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            emit this->firmwareModeUpdated(false, FirmwareMode::Normal);
-            return;
-    }
+/**
+ * @brief       Set the window to count pulses of fan speed.
+ */
+void BoardController::setSpeedWindow(quint16 window)
+{
+    CMDSetSpeedWindow command;
+    command.window = window;
+    this->transact(command, [](const ReplySetSpeedWindow &) -> void {});
 }
 
 /**
- * @brief       Set firmware mode.
+ * @brief       Set output speed in manual mode.
  */
-void BoardController::setFirmwareMode(FirmwareMode mode)
+void BoardController::setOutputSpeed(quint16 speed)
 {
-    if (! m_serialPort.isOpened()) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
-    m_serialPort.clearRead();
+    CMDSetOutputSpeed command;
+    command.speed = speed;
+    this->transact(command, [](const ReplySetOutputSpeed &) -> void {});
+}
 
-    // Send command.
-    CMDSetMode command;
-    command.header.cmdBegin = CMD_BEGIN;
-    command.header.cmdType  = CMDType::SetMode;
-    command.mode            = mode;
-
-    if (this->sendCommand(reinterpret_cast<const uint8_t *>(&command),
-                          sizeof(command))
-        < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_COMMAND_SEND_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
+/**
+ * @brief       Set output PWM in manual mode.
+ */
+void BoardController::setOutputPWM(quint8 dutyCycle)
+{
+    CMDSetOutputPWM command;
+    command.dutyCycle = dutyCycle;
+    this->transact(command, [](const ReplySetOutputPWM &) -> void {});
+}
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_COMMAND_SEND")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&command), sizeof(command))
-                    .toHex(' ')
-                    .toUpper())));
-
-    // Get reply.
-    ReplySetMode reply;
-    uint8_t *    pReply = reinterpret_cast<uint8_t *>(&reply);
-
-    // Receive first byte.
-    if (this->receiveReply(pReply, sizeof(reply)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
+/**
+ * @brief       Read port.
+ */
+void BoardController::readPort(ReadablePort port)
+{
+    CMDReadPort command;
+    command.port = port;
+    this->transact(command,
+                   [this, port](const ReplyReadPort &reply) -> void {
+                       emit this->portRead(port, reply.value);
+                   });
+}
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_REPLY")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&reply), sizeof(reply))
-                    .toHex(' ')
-                    .toUpper())));
-
-    switch (reply.header.replyType) {
-        case ReplyType::Success:
-            emit this->printInfo(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_SUCCEED"));
-            break;
+/**
+ * @brief       Write port.
+ */
+void BoardController::writedPort(WritablePort port, bool value)
+{
+    CMDWritePort command;
+    command.port  = port;
+    command.value = value ? 1 : 0;
+    this->transact(command, [](const ReplyWritePort &) -> void {});
+}
 
-        case ReplyType::Failed:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
+/**
+ * @brief       Get size of the config chunk at offset.
+ *
+ * @param[in]   offset      Offset of the chunk.
+ *
+ * @return      Size of the chunk.
+ */
+static uint8_t configChunkSize(uint8_t offset)
+{
+    return static_cast<uint8_t>(::std::min<size_t>(
+        CONFIG_CHUNK_MAX_SIZE, sizeof(FirmwareConfig) - offset));
+}
 
-        default:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY_PARSE_ERROR"));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
+/**
+ * @brief       Read config.
+ */
+void BoardController::readConfig()
+{
+    auto transfer        = ::std::make_shared<ConfigTransfer>();
+    transfer->chunksLeft = (sizeof(FirmwareConfig) + CONFIG_CHUNK_MAX_SIZE - 1)
+                           / CONFIG_CHUNK_MAX_SIZE;
+    transfer->failed     = false;
+
+    for (size_t offset = 0; offset < sizeof(FirmwareConfig);
+         offset += CONFIG_CHUNK_MAX_SIZE) {
+        this->readConfigChunk(transfer, static_cast<uint8_t>(offset),
+                              CONFIG_CHUNK_RETRIES);
     }
 }
 
 /**
- * @brief       Update fan speed.
+ * @brief       Write config.
  */
-void BoardController::updateSpeed()
+void BoardController::writeConfig(FirmwareConfig config)
 {
-    if (! m_serialPort.isOpened()) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
-    m_serialPort.clearRead();
+    auto transfer           = ::std::make_shared<ConfigTransfer>();
+    transfer->config        = config;
+    transfer->commitRetries = CONFIG_CHUNK_RETRIES;
+    this->writeConfigChunks(transfer);
+}
 
-    // Send command.
-    CMDGetInputSpeed command;
-    command.header.cmdBegin = CMD_BEGIN;
-    command.header.cmdType  = CMDType::GetInputSpeed;
-
-    if (this->sendCommand(reinterpret_cast<const uint8_t *>(&command),
-                          sizeof(command))
-        < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_COMMAND_SEND_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
+/**
+ * @brief       Write all chunks of config.
+ */
+void BoardController::writeConfigChunks(
+    ::std::shared_ptr<ConfigTransfer> transfer)
+{
+    transfer->chunksLeft = (sizeof(FirmwareConfig) + CONFIG_CHUNK_MAX_SIZE - 1)
+                           / CONFIG_CHUNK_MAX_SIZE;
+    transfer->failed     = false;
+
+    for (size_t offset = 0; offset < sizeof(FirmwareConfig);
+         offset += CONFIG_CHUNK_MAX_SIZE) {
+        this->writeConfigChunk(transfer, static_cast<uint8_t>(offset),
+                               CONFIG_CHUNK_RETRIES);
     }
+}
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_COMMAND_SEND")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&command), sizeof(command))
-                    .toHex(' ')
-                    .toUpper())));
-
-    // Get reply.
-    ReplyGetInputSpeed reply;
-    uint8_t *          pReply = reinterpret_cast<uint8_t *>(&reply);
-
-    // Receive first byte.
-    if (this->receiveReply(pReply, sizeof(uint8_t)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
+/**
+ * @brief       Set baud rate of both host and firmware.
+ */
+void BoardController::setBaudRate(quint32 baudRate)
+{
+    if (m_linkHeld || ! Serial::isBaudRateSupported(baudRate)) {
+        // Switching or not supported by the host.
+        this->traceError("STR_MESSAGE_OPERATION_FAILED");
+        emit this->baudRateUpdated(false, m_baudRate);
         return;
     }
-    switch (reply.header.replyType) {
-        case ReplyType::Success:
-            break;
 
-        case ReplyType::Failed:
-            emit this->printInfo(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY")
-                    .arg(QString::fromUtf8(
-                        QByteArray(reinterpret_cast<char *>(pReply),
-                                   sizeof(uint8_t))
-                            .toHex(' ')
-                            .toUpper())));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
+    // Replies of the commands in flight would be sent by firmware at the
+    // old baud rate after the host has switched, so new commands are held
+    // and the command is sent after the replies until the link is checked.
+    m_linkHeld = true;
+
+    CMDSetBaudRate command;
+    command.baudRate = baudRate;
+    this->transact(
+        command,
+        [this, baudRate](const ReplySetBaudRate &) -> void {
+            // Firmware switches after the reply has been sent.
+            if (! m_serialPort.setBaudRate(baudRate)) {
+                this->traceError("STR_MESSAGE_OPERATION_FAILED");
+                emit this->baudRateUpdated(false, m_baudRate);
+                this->releaseLink();
+                return;
+            }
+            m_baudRate = baudRate;
+
+            // The firmware falls back SERIAL_LINK_CHECK_TIMEOUT_MS after it
+            // switches, which is after the reply has been received.
+            auto deadline
+                = ::std::chrono::steady_clock::now()
+                  + ::std::chrono::milliseconds(SERIAL_LINK_CHECK_TIMEOUT_MS
+                                                + 500);
+            QTimer::singleShot(10, this, [this, deadline]() -> void {
+                this->checkLink(deadline, false);
+            });
+        },
+        [this]() -> void {
+            emit this->baudRateUpdated(false, m_baudRate);
+            this->releaseLink();
+        },
+        true);
+}
 
-        default:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY_PARSE_ERROR"));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
-    }
+/**
+ * @brief       Update command statistics.
+ */
+void BoardController::updateStatistics()
+{
+    emit this->statisticsUpdated(m_statistics);
+}
 
-    // Receive remaining data,
-    if (this->receiveReply(pReply + 1, sizeof(reply) - sizeof(uint8_t)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
+/**
+ * @brief       Save command statistics as csv.
+ */
+void BoardController::saveStatistics(QString fileName)
+{
+    QFile file(fileName);
+    if (! file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) {
+        this->traceError("STR_MESSAGE_STATISTICS_SAVE_FAILED", {fileName});
         return;
     }
+    QTextStream stream(&file);
+
+    // Summary.
+    stream << "command,latency,count,timeouts,parse_errors,min_us,mean_us,"
+              "p50_us,p90_us,p99_us,max_us\n";
+    for (auto &iter : m_statistics) {
+        const char *name = commandName(iter.first);
+        for (auto &latency :
+             {::std::make_pair("first_byte", &iter.second.firstByteLatency),
+              ::std::make_pair("complete", &iter.second.completeLatency)}) {
+            const LatencyHistogram &histogram = *latency.second;
+            stream << name << ',' << latency.first << ','
+                   << histogram.count() << ',' << iter.second.timeouts << ','
+                   << iter.second.parseErrors << ',' << histogram.min() << ','
+                   << histogram.mean() << ',' << histogram.percentile(50)
+                   << ',' << histogram.percentile(90) << ','
+                   << histogram.percentile(99) << ',' << histogram.max()
+                   << '\n';
+        }
+    }
+
+    // Buckets not empty.
+    stream << "\ncommand,latency,lower_us,upper_us,count\n";
+    for (auto &iter : m_statistics) {
+        const char *name = commandName(iter.first);
+        for (auto &latency :
+             {::std::make_pair("first_byte", &iter.second.firstByteLatency),
+              ::std::make_pair("complete", &iter.second.completeLatency)}) {
+            const LatencyHistogram &histogram = *latency.second;
+            for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+                if (histogram.bucketCount(i) == 0) {
+                    continue;
+                }
+                stream << name << ',' << latency.first << ','
+                       << LatencyHistogram::bucketLowerBound(i) << ','
+                       << LatencyHistogram::bucketUpperBound(i) << ','
+                       << histogram.bucketCount(i) << '\n';
+            }
+        }
+    }
+
+    stream.flush();
+    file.close();
+    this->traceInfo("STR_MESSAGE_STATISTICS_SAVED", {fileName});
+}
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_REPLY")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&reply), sizeof(reply))
-                    .toHex(' ')
-                    .toUpper())));
-    // Parse type.
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_OPERATION_SUCCEED"));
-    emit this->speedUpdated(reply.speed);
-    return;
+/**
+ * @brief       Clear command statistics.
+ */
+void BoardController::clearStatistics()
+{
+    m_statistics.clear();
 }
 
 /**
- * @brief       Update clock.
+ * @brief       Dispatch frames decoded by serial reader.
  */
-void BoardController::updateClock()
+void BoardController::onFramesReceived()
 {
-    if (! m_serialPort.isOpened()) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
+    // Frames pushed after acknowledged are notified again.
+    m_serialReader.acknowledge();
+
+    // Dispatch replies.
+    Frame frame;
+    while (m_serialReader.popFrame(frame)) {
+        if (frame.sequence == FRAME_SEQUENCE_PUSH) {
+            this->onTelemetryPushed(frame);
+            continue;
+        }
+
+        auto iter = m_inFlightCommands.find(frame.sequence);
+        if (iter == m_inFlightCommands.end()) {
+            // Reply of a command which has been timed out.
+            continue;
+        }
+        // Timestamps of the frame are taken by the serial reader, so the
+        // latencies do not include the time waiting for dispatching.
+        CommandStatistics &statistics
+            = m_statistics[static_cast<CMDType>(iter->second.data.front())];
+        statistics.firstByteLatency.record(frame.firstByteTime
+                                           - iter->second.sentTime);
+        statistics.completeLatency.record(frame.completeTime
+                                          - iter->second.sentTime);
+
+        ReplyHandler handler = ::std::move(iter->second.handler);
+        m_inFlightCommands.erase(iter);
+
+        this->traceData(TraceType::Reply, frame.payload, frame.length);
+        handler(frame.payload, frame.length);
+    }
+
+    if (m_serialReader.failed()) {
+        // The reader has stopped, the port is unusable until reopened, the
+        // device may have been removed so the baud rate is not restored.
+        QString name = m_serialPort.name();
+        this->traceError("STR_MESSAGE_REPLY_RECV_FAILED");
+        m_serialReader.stopReading();
+        m_serialPort.close();
+        m_baudRate = SERIAL_DEFAULT_BAUD_RATE;
+        this->failAllCommands();
+        this->traceInfo("STR_MESSAGE_PORT_CLOSED", {name});
+        this->updateOpenStatus();
         return;
     }
-    m_serialPort.clearRead();
 
-    // Send command.
-    CMDReadClock command;
-    command.header.cmdBegin = CMD_BEGIN;
-    command.header.cmdType  = CMDType::ReadClock;
-
-    if (this->sendCommand(reinterpret_cast<const uint8_t *>(&command),
-                          sizeof(command))
-        < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_COMMAND_SEND_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
+    // Send waiting commands.
+    this->sendWaitingCommands();
+}
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_COMMAND_SEND")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&command), sizeof(command))
-                    .toHex(' ')
-                    .toUpper())));
-
-    // Get reply.
-    ReplyReadClock reply;
-    uint8_t *      pReply = reinterpret_cast<uint8_t *>(&reply);
-
-    // Receive first byte.
-    if (this->receiveReply(pReply, sizeof(uint8_t)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
-    switch (reply.header.replyType) {
-        case ReplyType::Success:
-            break;
+/**
+ * @brief       Fail the commands whose reply is out of time.
+ */
+void BoardController::checkTimeouts()
+{
+    auto now = ::std::chrono::steady_clock::now();
+    ::std::deque<ReplyHandler> timedOut;
+    for (auto iter = m_inFlightCommands.begin();
+         iter != m_inFlightCommands.end();) {
+        if (iter->second.deadline <= now) {
+            ++m_statistics[static_cast<CMDType>(iter->second.data.front())]
+                  .timeouts;
+            timedOut.push_back(::std::move(iter->second.handler));
+            iter = m_inFlightCommands.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    for (auto &handler : timedOut) {
+        this->traceError("STR_MESSAGE_REPLY_OUT_OF_TIME");
+        handler(nullptr, -1);
+    }
+
+    // Send waiting commands.
+    this->sendWaitingCommands();
+}
 
-        case ReplyType::Failed:
-            emit this->printInfo(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY")
-                    .arg(QString::fromUtf8(
-                        QByteArray(reinterpret_cast<char *>(pReply),
-                                   sizeof(uint8_t))
-                            .toHex(' ')
-                            .toUpper())));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
+/**
+ * @brief       Read a chunk of config.
+ */
+void BoardController::readConfigChunk(
+    ::std::shared_ptr<ConfigTransfer> transfer, uint8_t offset, int retries)
+{
+    CMDReadConfig command;
+    command.offset = offset;
+    command.length = configChunkSize(offset);
 
-        default:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY_PARSE_ERROR"));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
+    // Called when failed.
+    auto fail = [this, transfer, offset, retries]() -> void {
+        if (transfer->failed) {
             return;
-    }
+        }
+        if (retries > 0) {
+            this->readConfigChunk(transfer, offset, retries - 1);
+            return;
+        }
+        transfer->failed = true;
+        emit this->configRead(false, transfer->config);
+    };
+
+    this->transact(
+        command,
+        [this, transfer, command, fail](const ReplyReadConfig &reply) -> void {
+            if (reply.offset != command.offset
+                || reply.length != command.length) {
+                fail();
+                return;
+            }
+            ::std::copy(reply.data, reply.data + reply.length,
+                        reinterpret_cast<uint8_t *>(&transfer->config)
+                            + reply.offset);
+            if (--transfer->chunksLeft == 0 && ! transfer->failed) {
+                emit this->configRead(true, transfer->config);
+            }
+        },
+        fail);
+}
 
-    // Receive remaining data,
-    if (this->receiveReply(pReply + 1, sizeof(reply) - sizeof(uint8_t)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
+/**
+ * @brief       Write a chunk of config.
+ */
+void BoardController::writeConfigChunk(
+    ::std::shared_ptr<ConfigTransfer> transfer, uint8_t offset, int retries)
+{
+    const uint8_t *data
+        = reinterpret_cast<const uint8_t *>(&transfer->config) + offset;
+
+    CMDWriteConfig command = {};
+    command.offset         = offset;
+    command.length         = configChunkSize(offset);
+    ::std::copy(data, data + command.length, command.data);
+    command.crc = config_chunk_crc(command.offset, command.length, data);
+
+    this->transact(
+        command,
+        [this, transfer](const ReplyWriteConfig &) -> void {
+            if (--transfer->chunksLeft == 0 && ! transfer->failed) {
+                this->commitConfig(transfer);
+            }
+        },
+        [this, transfer, offset, retries]() -> void {
+            if (transfer->failed) {
+                return;
+            }
+            if (retries > 0) {
+                this->writeConfigChunk(transfer, offset, retries - 1);
+                return;
+            }
+            transfer->failed = true;
+            emit this->configWritten(false);
+        });
+}
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_REPLY")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&reply), sizeof(reply))
-                    .toHex(' ')
-                    .toUpper())));
-    // Parse type.
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_OPERATION_SUCCEED"));
-    emit this->clockUpdated(reply.bootTime);
-    return;
+/**
+ * @brief       Commit config written.
+ */
+void BoardController::commitConfig(::std::shared_ptr<ConfigTransfer> transfer)
+{
+    CMDCommitConfig command;
+    command.crc = config_chunk_crc(
+        0, static_cast<uint8_t>(sizeof(FirmwareConfig)),
+        reinterpret_cast<const uint8_t *>(&transfer->config));
+
+    this->transact(
+        command,
+        [this](const ReplyCommitConfig &) -> void {
+            emit this->configWritten(true);
+        },
+        [this, transfer]() -> void {
+            // A chunk may have been corrupted, committing the same chunks
+            // again would fail again.
+            if (transfer->commitRetries > 0) {
+                --transfer->commitRetries;
+                this->writeConfigChunks(transfer);
+                return;
+            }
+            emit this->configWritten(false);
+        });
 }
 
 /**
- * @brief       Read port.
+ * @brief       Send command.
  */
-void BoardController::readPort(ReadablePort port)
+void BoardController::sendCommand(const uint8_t *data,
+                                  size_t         size,
+                                  ReplyHandler   handler,
+                                  bool           exclusive)
 {
-    if (! m_serialPort.isOpened()) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
-    m_serialPort.clearRead();
+    PendingCommand command;
+    command.data.assign(data, data + size);
+    command.handler   = ::std::move(handler);
+    command.exclusive = exclusive;
+    m_waitingCommands.push_back(::std::move(command));
 
-    // Send command.
-    CMDReadPort command;
-    command.header.cmdBegin = CMD_BEGIN;
-    command.header.cmdType  = CMDType::ReadPort;
-    command.port            = port;
-
-    if (this->sendCommand(reinterpret_cast<const uint8_t *>(&command),
-                          sizeof(command))
-        < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_COMMAND_SEND_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
+    this->sendWaitingCommands();
+}
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_COMMAND_SEND")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&command), sizeof(command))
-                    .toHex(' ')
-                    .toUpper())));
-
-    // Get reply.
-    ReplyReadPort reply;
-    uint8_t *     pReply = reinterpret_cast<uint8_t *>(&reply);
-
-    // Receive first byte.
-    if (this->receiveReply(pReply, sizeof(uint8_t)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
-    }
-    switch (reply.header.replyType) {
-        case ReplyType::Success:
+/**
+ * @brief       Send queued commands while the window is not full.
+ */
+void BoardController::sendWaitingCommands()
+{
+    while (m_inFlightCommands.size() < FRAME_WINDOW_SIZE) {
+        // While the link is held only exclusive commands are sent, an
+        // exclusive command is sent alone.
+        auto iter = m_waitingCommands.begin();
+        if (m_linkHeld) {
+            iter = ::std::find_if(m_waitingCommands.begin(),
+                                  m_waitingCommands.end(),
+                                  [](const PendingCommand &command) -> bool {
+                                      return command.exclusive;
+                                  });
+        }
+        if (iter == m_waitingCommands.end()
+            || (iter->exclusive && ! m_inFlightCommands.empty())) {
             break;
+        }
+        PendingCommand command = ::std::move(*iter);
+        m_waitingCommands.erase(iter);
+
+        // Sequence FRAME_SEQUENCE_PUSH is reserved.
+        do {
+            ++m_sequence;
+        } while (m_sequence == FRAME_SEQUENCE_PUSH
+                 || m_inFlightCommands.find(m_sequence)
+                        != m_inFlightCommands.end());
+
+        // Send frame.
+        ::std::vector<uint8_t> frame = encodeFrame(
+            m_sequence, command.data.data(), command.data.size());
+        command.sentTime = ::std::chrono::steady_clock::now();
+        if (m_serialPort.write(frame.data(), frame.size()) < 0) {
+            this->traceError("STR_MESSAGE_COMMAND_SEND_FAILED");
+            command.handler(nullptr, -1);
+            continue;
+        }
+
+        this->traceData(TraceType::Command, command.data.data(),
+                        command.data.size());
+
+        command.deadline = command.sentTime + ::std::chrono::milliseconds(1000);
+        m_inFlightCommands.emplace(m_sequence, ::std::move(command));
+    }
+
+    this->updateTimeoutTimer();
+}
 
-        case ReplyType::Failed:
-            emit this->printInfo(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY")
-                    .arg(QString::fromUtf8(
-                        QByteArray(reinterpret_cast<char *>(pReply),
-                                   sizeof(uint8_t))
-                            .toHex(' ')
-                            .toUpper())));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
+/**
+ * @brief       Release the link held while switching baud rate.
+ */
+void BoardController::releaseLink()
+{
+    m_linkHeld = false;
+    this->sendWaitingCommands();
+}
 
-        default:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY_PARSE_ERROR"));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
+/**
+ * @brief       Fail all commands.
+ */
+void BoardController::failAllCommands()
+{
+    ::std::deque<ReplyHandler> handlers;
+    for (auto &command : m_inFlightCommands) {
+        handlers.push_back(::std::move(command.second.handler));
     }
+    m_inFlightCommands.clear();
+    for (auto &command : m_waitingCommands) {
+        handlers.push_back(::std::move(command.handler));
+    }
+    m_waitingCommands.clear();
+    this->updateTimeoutTimer();
 
-    // Receive remaining data,
-    if (this->receiveReply(pReply + 1, sizeof(reply) - sizeof(uint8_t)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
+    for (auto &handler : handlers) {
+        handler(nullptr, -1);
+    }
+}
+
+/**
+ * @brief       Handle telemetry pushed by firmware.
+ */
+void BoardController::onTelemetryPushed(const Frame &frame)
+{
+    // Pushed frames are not printed, they would flood the message widget.
+    ReplyGetTelemetry telemetry;
+    if (frame.length != sizeof(telemetry)) {
+        this->traceError("STR_MESSAGE_REPLY_PARSE_ERROR");
+        return;
+    }
+    ::std::copy(frame.payload, frame.payload + sizeof(telemetry),
+                reinterpret_cast<uint8_t *>(&telemetry));
+    if (telemetry.header.replyType != ReplyType::Success) {
+        this->traceError("STR_MESSAGE_REPLY_PARSE_ERROR");
         return;
     }
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_REPLY")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&reply), sizeof(reply))
-                    .toHex(' ')
-                    .toUpper())));
-    // Parse type.
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_OPERATION_SUCCEED"));
-    emit this->portRead(port, reply.value);
-    return;
+    emit this->telemetryUpdated(telemetry.speed, telemetry.dutyCycle,
+                                telemetry.frequency, telemetry.bootTime);
 }
 
 /**
- * @brief       Write port.
+ * @brief       Start or stop the timer to check the deadlines of replies.
  */
-void BoardController::writedPort(WritablePort port, bool value)
+void BoardController::updateTimeoutTimer()
 {
-    if (! m_serialPort.isOpened()) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-        return;
+    if (m_inFlightCommands.empty()) {
+        m_timeoutTimer->stop();
+    } else if (! m_timeoutTimer->isActive()) {
+        m_timeoutTimer->start();
     }
-    m_serialPort.clearRead();
+}
 
-    // Send command.
-    CMDWritePort command;
-    command.header.cmdBegin = CMD_BEGIN;
-    command.header.cmdType  = CMDType::WritePort;
-    command.port            = port;
-    command.value           = value ? 1 : 0;
-
-    if (this->sendCommand(reinterpret_cast<const uint8_t *>(&command),
-                          sizeof(command))
-        < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_COMMAND_SEND_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
+/**
+ * @brief       Check the link after switching baud rate, falls back to
+ *              SERIAL_DEFAULT_BAUD_RATE on failure.
+ */
+void BoardController::checkLink(
+    ::std::chrono::steady_clock::time_point deadline,
+    bool                                    confirming)
+{
+    if (! m_serialPort.isOpened()) {
+        m_linkHeld = false;
         return;
     }
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_COMMAND_SEND")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&command), sizeof(command))
-                    .toHex(' ')
-                    .toUpper())));
-
-    // Get reply.
-    ReplyWritePort reply;
-    uint8_t *      pReply = reinterpret_cast<uint8_t *>(&reply);
-
-    // Receive first byte.
-    if (this->receiveReply(pReply, sizeof(reply)) < 0) {
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        emit this->printError(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
+    CMDGetMode command;
+    this->transact(
+        command,
+        [this, deadline, confirming](const ReplyGetMode &) -> void {
+            if (! confirming) {
+                this->checkLink(deadline, true);
+                return;
+            }
+            this->traceInfo("STR_MESSAGE_BAUD_RATE_SET",
+                            {QString::number(m_baudRate)});
+            emit this->baudRateUpdated(true, m_baudRate);
+            this->releaseLink();
+        },
+        [this, deadline, confirming]() -> void {
+            if (::std::chrono::steady_clock::now() < deadline) {
+                this->checkLink(deadline, confirming);
+                return;
+            }
+
+            // Fall back, the firmware has fallen back as the link has not
+            // been confirmed.
+            this->traceError("STR_MESSAGE_BAUD_RATE_FALLBACK",
+                             {QString::number(m_baudRate),
+                              QString::number(SERIAL_DEFAULT_BAUD_RATE)});
+            m_baudRate = SERIAL_DEFAULT_BAUD_RATE;
+            m_serialPort.setBaudRate(m_baudRate);
+            emit this->baudRateUpdated(false, m_baudRate);
+            this->releaseLink();
+        },
+        true);
+}
+
+/**
+ * @brief       Ask firmware to restore the default baud rate before closing
+ *              the port.
+ */
+void BoardController::restoreDefaultBaudRate()
+{
+    if (m_baudRate == SERIAL_DEFAULT_BAUD_RATE) {
         return;
     }
 
-    emit this->printInfo(
-        QDateTime::currentDateTime(),
-        m_stringTable->getString("STR_MESSAGE_REPLY")
-            .arg(QString::fromUtf8(
-                QByteArray(reinterpret_cast<char *>(&reply), sizeof(reply))
-                    .toHex(' ')
-                    .toUpper())));
-
-    switch (reply.header.replyType) {
-        case ReplyType::Success:
-            emit this->printInfo(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_SUCCEED"));
-            break;
+    // The reply is not waited, firmware switches after sending it.
+    CMDSetBaudRate command;
+    command.header.cmdType = CMDType::SetBaudRate;
+    command.baudRate       = SERIAL_DEFAULT_BAUD_RATE;
+    do {
+        ++m_sequence;
+    } while (m_sequence == FRAME_SEQUENCE_PUSH);
 
-        case ReplyType::Failed:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
+    ::std::vector<uint8_t> frame
+        = encodeFrame(m_sequence, &command, sizeof(command));
+    m_serialPort.write(frame.data(), frame.size());
+    m_baudRate = SERIAL_DEFAULT_BAUD_RATE;
+}
 
-        default:
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_REPLY_PARSE_ERROR"));
-            emit this->printError(
-                QDateTime::currentDateTime(),
-                m_stringTable->getString("STR_MESSAGE_OPERATION_FAILED"));
-            return;
+/**
+ * @brief       Trace error message.
+ */
+void BoardController::traceError(const char *stringId, QStringList args)
+{
+    if (m_traceLevel < TraceLevel::Errors) {
+        return;
     }
+
+    TraceRecord record;
+    record.time     = ::std::chrono::steady_clock::now();
+    record.type     = TraceType::Error;
+    record.level    = m_traceLevel;
+    record.stringId = stringId;
+    record.args     = ::std::move(args);
+    record.dataType = 0;
+    record.size     = 0;
+    emit this->traced(record);
 }
 
 /**
- * @brief       Send command.
+ * @brief       Trace info message.
  */
-qint64 BoardController::sendCommand(const uint8_t *data, size_t size)
+void BoardController::traceInfo(const char *stringId, QStringList args)
 {
-    // Send data.
-    ssize_t ret = m_serialPort.write(data, size);
-    if (ret < 0) {
-        return -1;
+    if (m_traceLevel < TraceLevel::Summary) {
+        return;
     }
 
-    return ret;
+    TraceRecord record;
+    record.time     = ::std::chrono::steady_clock::now();
+    record.type     = TraceType::Info;
+    record.level    = m_traceLevel;
+    record.stringId = stringId;
+    record.args     = ::std::move(args);
+    record.dataType = 0;
+    record.size     = 0;
+    emit this->traced(record);
 }
 
 /**
- * @brief       Receive reply.
+ * @brief       Trace command or reply.
  */
-qint64 BoardController::receiveReply(uint8_t *data, size_t size)
+void BoardController::traceData(TraceType type,
+                                const uint8_t *data,
+                                size_t         size)
 {
-    // Receive data.
-    ssize_t received
-        = m_serialPort.read(data, size, ::std::chrono::milliseconds(1000));
-
-    if (received < 0) {
-        emit this->printInfo(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_RECV_FAILED"));
-        return -1;
-    } else if (static_cast<size_t>(received) < size) {
-        emit this->printInfo(
-            QDateTime::currentDateTime(),
-            m_stringTable->getString("STR_MESSAGE_REPLY_OUT_OF_TIME"));
-        return -1;
+    if (m_traceLevel < TraceLevel::Verbose) {
+        return;
     }
 
-    return received;
+    // Data is copied in hex level only, formatted by the sink.
+    TraceRecord record;
+    record.time     = ::std::chrono::steady_clock::now();
+    record.type     = type;
+    record.level    = m_traceLevel;
+    record.stringId = nullptr;
+    record.dataType = size > 0 ? data[0] : 0;
+    record.size     = size;
+    if (m_traceLevel == TraceLevel::Hex) {
+        record.data = QByteArray(reinterpret_cast<const char *>(data),
+                                 static_cast<int>(size));
+    }
+    emit this->traced(record);
 }
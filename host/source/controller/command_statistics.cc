@@ -0,0 +1,63 @@
+#include <controller/command_statistics.h>
+
+/**
+ * @brief       Get the name of a command type.
+ */
+const char *commandName(CMDType type)
+{
+    switch (type) {
+        case CMDType::GetMode:
+            return "GetMode";
+
+        case CMDType::SetMode:
+            return "SetMode";
+
+        case CMDType::ReadPort:
+            return "ReadPort";
+
+        case CMDType::WritePort:
+            return "WritePort";
+
+        case CMDType::GetInputSpeed:
+            return "GetInputSpeed";
+
+        case CMDType::GetInputPWM:
+            return "GetInputPWM";
+
+        case CMDType::GetTelemetry:
+            return "GetTelemetry";
+
+        case CMDType::SubscribeTelemetry:
+            return "SubscribeTelemetry";
+
+        case CMDType::SetSpeedMethod:
+            return "SetSpeedMethod";
+
+        case CMDType::SetSpeedWindow:
+            return "SetSpeedWindow";
+
+        case CMDType::SetOutputSpeed:
+            return "SetOutputSpeed";
+
+        case CMDType::SetOutputPWM:
+            return "SetOutputPWM";
+
+        case CMDType::ReadConfig:
+            return "ReadConfig";
+
+        case CMDType::WriteConfig:
+            return "WriteConfig";
+
+        case CMDType::CommitConfig:
+            return "CommitConfig";
+
+        case CMDType::ReadClock:
+            return "ReadClock";
+
+        case CMDType::SetBaudRate:
+            return "SetBaudRate";
+
+        default:
+            return "Unknown";
+    }
+}
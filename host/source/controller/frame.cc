@@ -0,0 +1,114 @@
+#include <algorithm>
+
+#include <controller/frame.h>
+
+/**
+ * @brief       Encode frame.
+ */
+::std::vector<uint8_t>
+    encodeFrame(uint8_t sequence, const void *payload, size_t size)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(payload);
+
+    ::std::vector<uint8_t> ret;
+    ret.reserve(sizeof(FrameHeader) + size + 1);
+    ret.push_back(FRAME_BEGIN);
+    ret.push_back(static_cast<uint8_t>(size));
+    ret.push_back(sequence);
+    ret.insert(ret.end(), p, p + size);
+
+    uint8_t crc = FRAME_CRC_INIT;
+    for (auto iter = ret.begin() + 1; iter != ret.end(); ++iter) {
+        crc = frame_crc_update(crc, *iter);
+    }
+    ret.push_back(crc);
+
+    return ret;
+}
+
+/**
+ * @brief       Constructor.
+ */
+FrameDecoder::FrameDecoder() {}
+
+/**
+ * @brief       Push bytes received.
+ */
+void FrameDecoder::push(const uint8_t                          *data,
+                        size_t                                  size,
+                        ::std::chrono::steady_clock::time_point time)
+{
+    if (! m_times.empty() && time - m_times.back() > BYTE_TIMEOUT) {
+        this->clear();
+    }
+
+    m_buffer.insert(m_buffer.end(), data, data + size);
+    m_times.insert(m_times.end(), size, time);
+}
+
+/**
+ * @brief       Pop next frame.
+ */
+bool FrameDecoder::pop(Frame &frame)
+{
+    while (true) {
+        // Search the beginning of the frame.
+        auto begin = ::std::find(m_buffer.begin(), m_buffer.end(), FRAME_BEGIN);
+        m_times.erase(m_times.begin(),
+                      m_times.begin() + (begin - m_buffer.begin()));
+        m_buffer.erase(m_buffer.begin(), begin);
+        if (m_buffer.size() < sizeof(FrameHeader)) {
+            return false;
+        }
+
+        // Check length.
+        uint8_t length = m_buffer[1];
+        if (length == 0 || length > FRAME_PAYLOAD_MAX_SIZE) {
+            m_buffer.erase(m_buffer.begin());
+            m_times.erase(m_times.begin());
+            continue;
+        }
+        size_t frameSize = sizeof(FrameHeader) + length + 1;
+        if (m_buffer.size() < frameSize) {
+            return false;
+        }
+
+        // Check crc.
+        uint8_t crc = FRAME_CRC_INIT;
+        for (size_t i = 1; i < frameSize - 1; ++i) {
+            crc = frame_crc_update(crc, m_buffer[i]);
+        }
+        if (crc != m_buffer[frameSize - 1]) {
+            m_buffer.erase(m_buffer.begin());
+            m_times.erase(m_times.begin());
+            continue;
+        }
+
+        // Get frame.
+        frame.sequence = m_buffer[2];
+        frame.length   = length;
+        ::std::copy(m_buffer.begin() + sizeof(FrameHeader),
+                    m_buffer.begin() + sizeof(FrameHeader) + length,
+                    frame.payload);
+        frame.firstByteTime = m_times.front();
+        frame.completeTime  = m_times[frameSize - 1];
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + frameSize);
+        m_times.erase(m_times.begin(), m_times.begin() + frameSize);
+
+        return true;
+    }
+}
+
+/**
+ * @brief       Drop all bytes.
+ */
+void FrameDecoder::clear()
+{
+    m_buffer.clear();
+    m_times.clear();
+}
+
+/**
+ * @brief       Destructor.
+ */
+FrameDecoder::~FrameDecoder() {}
@@ -0,0 +1,156 @@
+#include <algorithm>
+
+#include <controller/latency_histogram.h>
+
+/**
+ * @brief       Constructor.
+ */
+LatencyHistogram::LatencyHistogram()
+{
+    this->clear();
+}
+
+/**
+ * @brief       Record latency.
+ */
+void LatencyHistogram::record(::std::chrono::steady_clock::duration latency)
+{
+    int64_t us
+        = ::std::chrono::duration_cast<::std::chrono::microseconds>(latency)
+              .count();
+    uint64_t value = us > 0 ? ::std::min(static_cast<uint64_t>(us), MAX_VALUE)
+                            : 0;
+
+    ++m_buckets[bucketIndex(value)];
+    ++m_count;
+    m_sum += value;
+    m_min = ::std::min(m_min, value);
+    m_max = ::std::max(m_max, value);
+}
+
+/**
+ * @brief       Drop all values.
+ */
+void LatencyHistogram::clear()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_sum   = 0;
+    m_min   = MAX_VALUE;
+    m_max   = 0;
+}
+
+/**
+ * @brief       Get the number of values.
+ */
+uint64_t LatencyHistogram::count() const
+{
+    return m_count;
+}
+
+/**
+ * @brief       Get min value(us).
+ */
+uint64_t LatencyHistogram::min() const
+{
+    return m_count == 0 ? 0 : m_min;
+}
+
+/**
+ * @brief       Get max value(us).
+ */
+uint64_t LatencyHistogram::max() const
+{
+    return m_max;
+}
+
+/**
+ * @brief       Get mean value(us).
+ */
+uint64_t LatencyHistogram::mean() const
+{
+    return m_count == 0 ? 0 : m_sum / m_count;
+}
+
+/**
+ * @brief       Get percentile(us).
+ */
+uint64_t LatencyHistogram::percentile(double percentile) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    // Number of values at or below the percentile, at least 1.
+    uint64_t rank = static_cast<uint64_t>(
+        static_cast<double>(m_count) * ::std::clamp(percentile, 0.0, 100.0)
+        / 100.0);
+    rank = ::std::max<uint64_t>(rank, 1);
+
+    uint64_t counted = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counted += m_buckets[i];
+        if (counted >= rank) {
+            return ::std::min(bucketUpperBound(i), m_max);
+        }
+    }
+
+    return m_max;
+}
+
+/**
+ * @brief       Get the number of values in bucket.
+ */
+uint64_t LatencyHistogram::bucketCount(size_t index) const
+{
+    return m_buckets[index];
+}
+
+/**
+ * @brief       Get the lower bound of bucket(us).
+ */
+uint64_t LatencyHistogram::bucketLowerBound(size_t index)
+{
+    if (index < SUB_BUCKET_COUNT * 2) {
+        return index;
+    }
+
+    size_t shift = index / SUB_BUCKET_COUNT - 1;
+    return static_cast<uint64_t>(index - shift * SUB_BUCKET_COUNT) << shift;
+}
+
+/**
+ * @brief       Get the upper bound of bucket(us).
+ */
+uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index + 1 >= BUCKET_COUNT) {
+        return MAX_VALUE;
+    }
+
+    return bucketLowerBound(index + 1) - 1;
+}
+
+/**
+ * @brief       Destructor.
+ */
+LatencyHistogram::~LatencyHistogram() {}
+
+/**
+ * @brief       Get the index of the bucket of value.
+ */
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKET_COUNT * 2) {
+        return static_cast<size_t>(value);
+    }
+
+    // Keep SUB_BUCKET_BITS + 1 significant bits.
+    size_t msb = 0;
+    while ((value >> (msb + 1)) != 0) {
+        ++msb;
+    }
+    size_t shift = msb - SUB_BUCKET_BITS;
+
+    return shift * SUB_BUCKET_COUNT + static_cast<size_t>(value >> shift);
+}
@@ -0,0 +1,115 @@
+#include <QtCore/QDebug>
+
+#include <controller/serial_reader.h>
+
+/**
+ * @brief       Constructor.
+ */
+SerialReader::SerialReader(Serial *serial, ::std::function<void()> notify) :
+    QThread(nullptr), m_serial(serial), m_notify(notify), m_stop(false),
+    m_failed(false), m_notifyPending(false)
+{}
+
+/**
+ * @brief       Start reading, the port must have been opened.
+ */
+void SerialReader::startReading()
+{
+    this->stopReading();
+
+    m_frameDecoder.clear();
+    m_frames.clear();
+    m_stop.store(false);
+    m_failed.store(false);
+    m_notifyPending.store(false);
+    this->start();
+}
+
+/**
+ * @brief       Stop reading and wait for the reader thread.
+ */
+void SerialReader::stopReading()
+{
+    m_stop.store(true);
+    this->wait();
+}
+
+/**
+ * @brief       Acknowledge the notification, consumer only.
+ */
+void SerialReader::acknowledge()
+{
+    m_notifyPending.store(false);
+}
+
+/**
+ * @brief       Pop frame decoded, consumer only.
+ */
+bool SerialReader::popFrame(Frame &frame)
+{
+    return m_frames.pop(frame);
+}
+
+/**
+ * @brief       Check if the read failed.
+ */
+bool SerialReader::failed() const
+{
+    return m_failed.load();
+}
+
+/**
+ * @brief       Destructor.
+ */
+SerialReader::~SerialReader()
+{
+    this->stopReading();
+}
+
+/**
+ * @brief       Thread entry.
+ */
+void SerialReader::run()
+{
+    while (! m_stop.load()) {
+        // Wait for data, wake up periodically to check the stop flag.
+        if (! m_serial->waitForReadyRead(::std::chrono::milliseconds(50))) {
+            continue;
+        }
+        auto time = ::std::chrono::steady_clock::now();
+
+        // Read.
+        uint8_t buffer[256];
+        ssize_t received = m_serial->readAvailable(buffer, sizeof(buffer));
+        if (received < 0) {
+            m_failed.store(true);
+            this->notify();
+            return;
+        }
+        m_frameDecoder.push(buffer, static_cast<size_t>(received), time);
+
+        // Decode.
+        Frame frame;
+        bool  pushed = false;
+        while (m_frameDecoder.pop(frame)) {
+            if (m_frames.push(frame)) {
+                pushed = true;
+            } else {
+                qWarning() << "Frame ring full, frame dropped.";
+            }
+        }
+        if (pushed) {
+            this->notify();
+        }
+    }
+}
+
+/**
+ * @brief       Notify the consumer if not notified.
+ */
+void SerialReader::notify()
+{
+    if (! m_notifyPending.exchange(true)) {
+        m_notify();
+    }
+}
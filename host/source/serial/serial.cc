@@ -1,9 +1,20 @@
+#include <algorithm>
 #include <memory>
 
 #include <QtCore/QDebug>
 
 #include <serial/serial.h>
 
+/**
+ * @brief       Check if the baud rate is in BAUD_RATES.
+ */
+bool Serial::isBaudRateSupported(uint32_t baudRate)
+{
+    return ::std::find(::std::begin(BAUD_RATES), ::std::end(BAUD_RATES),
+                       baudRate)
+           != ::std::end(BAUD_RATES);
+}
+
 #if defined(OS_WINDOWS)
 
     #include <Windows.h>
@@ -76,6 +87,27 @@ bool Serial::open(const QString &name)
     return true;
 }
 
+/**
+ * @brief       Set baud rate.
+ */
+bool Serial::setBaudRate(uint32_t baudRate)
+{
+    if (! isOpened()) {
+        return false;
+    }
+
+    DCB dcb;
+    if (! ::GetCommState(m_nativeHandle, &dcb)) {
+        return false;
+    }
+    dcb.BaudRate = static_cast<DWORD>(baudRate);
+    if (! ::SetCommState(m_nativeHandle, &dcb)) {
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * @nrief       Get device name.
  */
@@ -146,6 +178,63 @@ ssize_t
     return static_cast<ssize_t>(sizeRead);
 }
 
+/**
+ * @brief       Get the number of bytes which can be read without blocking.
+ */
+ssize_t Serial::available()
+{
+    if (! isOpened()) {
+        return -1;
+    }
+
+    DWORD   errors;
+    COMSTAT stat;
+    if (! ::ClearCommError(m_nativeHandle, &errors, &stat)) {
+        return -1;
+    }
+
+    return static_cast<ssize_t>(stat.cbInQue);
+}
+
+/**
+ * @brief       Wait until there are bytes to read.
+ */
+bool Serial::waitForReadyRead(::std::chrono::milliseconds timeout)
+{
+    ::std::chrono::steady_clock::time_point endTime
+        = ::std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        // On failure the read following reports it.
+        if (this->available() != 0) {
+            return true;
+        }
+        if (::std::chrono::steady_clock::now() >= endTime) {
+            return false;
+        }
+        ::Sleep(1);
+    }
+}
+
+/**
+ * @brief       Read bytes available without blocking.
+ */
+ssize_t Serial::readAvailable(void *buffer, size_t size)
+{
+    ssize_t sizeAvailable = this->available();
+    if (sizeAvailable <= 0) {
+        return sizeAvailable;
+    }
+
+    DWORD sizeToRead = static_cast<DWORD>(
+        ::std::min(static_cast<size_t>(sizeAvailable), size));
+    DWORD sizeRead = 0;
+    if (! ::ReadFile(m_nativeHandle, buffer, sizeToRead, &sizeRead, nullptr)) {
+        return -1;
+    }
+
+    return static_cast<ssize_t>(sizeRead);
+}
+
 /**
  * @brief       Write bytes.
  */
@@ -204,16 +293,20 @@ Serial::~Serial()
     #include <errno.h>
 
     #include <fcntl.h>
-    #include <sys/select.h>
+    #include <poll.h>
+    #include <sys/epoll.h>
     #include <sys/stat.h>
     #include <sys/types.h>
     #include <termios.h>
     #include <unistd.h>
 
+/// Size of each read from the port.
+static const size_t READ_CHUNK_SIZE = 4096;
+
 /**
  * @brief       Constructor.
  */
-Serial::Serial() : m_name(""), m_nativeHandle(-1) {}
+Serial::Serial() : m_name(""), m_nativeHandle(-1), m_epollFd(-1) {}
 
 /**
  * @brief       Check opened.
@@ -233,7 +326,8 @@ bool Serial::open(const QString &name)
     }
 
     // Open.
-    int fd = ::open(QString("/dev/%1").arg(name).toUtf8(), O_RDWR | O_NOCTTY);
+    int fd = ::open(QString("/dev/%1").arg(name).toUtf8(),
+                    O_RDWR | O_NOCTTY | O_NONBLOCK);
     if (fd < 0) {
         return false;
     }
@@ -252,9 +346,82 @@ bool Serial::open(const QString &name)
         return false;
     }
 
+    // Register the port to epoll once.
+    int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        return false;
+    }
+    ::std::unique_ptr<int, void (*)(int *)> autoCloseEpoll(
+        &epollFd, [](int *fd) -> void {
+            ::close(*fd);
+        });
+
+    struct epoll_event event;
+    event.events  = EPOLLIN;
+    event.data.fd = fd;
+    if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        return false;
+    }
+
     autoClose.release();
+    autoCloseEpoll.release();
     m_nativeHandle = fd;
+    m_epollFd      = epollFd;
     m_name         = name;
+    m_readBuffer.clear();
+
+    return true;
+}
+
+/**
+ * @brief       Set baud rate.
+ */
+bool Serial::setBaudRate(uint32_t baudRate)
+{
+    if (! this->isOpened()) {
+        return false;
+    }
+
+    speed_t speed;
+    switch (baudRate) {
+        case 9600:
+            speed = B9600;
+            break;
+
+        case 19200:
+            speed = B19200;
+            break;
+
+        case 38400:
+            speed = B38400;
+            break;
+
+        case 57600:
+            speed = B57600;
+            break;
+
+        case 115200:
+            speed = B115200;
+            break;
+
+        default:
+            return false;
+    }
+
+    // Wait until the data written has been sent, then change speed.
+    struct termios termOptions;
+    if (::tcgetattr(m_nativeHandle, &termOptions) < 0) {
+        return false;
+    }
+    ::cfsetispeed(&termOptions, speed);
+    ::cfsetospeed(&termOptions, speed);
+    if (::tcsetattr(m_nativeHandle, TCSADRAIN, &termOptions) < 0) {
+        char errBuf[256];
+        int  err = errno;
+        qWarning() << "Tcsetattr failed with errno " << err << " : "
+                   << ::strerror_r(err, errBuf, sizeof(errBuf)) << ".";
+        return false;
+    }
 
     return true;
 }
@@ -273,9 +440,12 @@ const QString &Serial::name() const
 void Serial::close()
 {
     if (this->isOpened()) {
+        ::close(m_epollFd);
         ::close(m_nativeHandle);
+        m_epollFd      = -1;
         m_nativeHandle = -1;
         m_name         = "";
+        m_readBuffer.clear();
     }
 }
 
@@ -294,54 +464,100 @@ ssize_t
     size_t   sizeRead = 0;
     ::std::chrono::steady_clock::time_point endTime
         = ::std::chrono::steady_clock::now() + timeout;
-    ::std::chrono::milliseconds timeRemain = timeout;
 
-    while (sizeRead < size) {
+    while (true) {
+        ssize_t readRet = this->readAvailable(p + sizeRead, size - sizeRead);
+        if (readRet < 0) {
+            return -1;
+        }
+        sizeRead += static_cast<size_t>(readRet);
+        if (sizeRead >= size) {
+            break;
+        }
+
         // Wait for data.
-        fd_set readFds;
-        FD_ZERO(&readFds);
-        FD_SET(m_nativeHandle, &readFds);
+        auto now = ::std::chrono::steady_clock::now();
+        if (now >= endTime) {
+            break;
+        }
+        this->waitForReadyRead(
+            ::std::chrono::duration_cast<::std::chrono::milliseconds>(endTime
+                                                                     - now));
+    }
 
-        timeval timeToWait;
-        timeToWait.tv_sec  = timeRemain.count() / 10000;
-        timeToWait.tv_usec = timeRemain.count() % 1000 * 1000;
+    return static_cast<ssize_t>(sizeRead);
+}
 
-        if (::select(1, &readFds, nullptr, nullptr, &timeToWait) < 0) {
-            char errBuf[256];
-            int  err = errno;
-            qWarning() << "Select failed with errno " << err << " : "
-                       << ::strerror_r(err, errBuf, sizeof(errBuf)) << ".";
-            if (errno == ETIMEDOUT) {
-                return static_cast<ssize_t>(sizeRead);
-            } else {
-                return -1;
-            }
-        }
+/**
+ * @brief       Get the number of bytes which can be read without blocking.
+ */
+ssize_t Serial::available()
+{
+    if (! this->isOpened()) {
+        return -1;
+    }
 
-        // Read.
-        ssize_t readRet = ::read(m_nativeHandle, p + sizeRead, size - sizeRead);
-        if (readRet < 0) {
+    if (! this->fillReadBuffer()) {
+        return -1;
+    }
+
+    return static_cast<ssize_t>(m_readBuffer.size());
+}
+
+/**
+ * @brief       Wait until there are bytes to read.
+ */
+bool Serial::waitForReadyRead(::std::chrono::milliseconds timeout)
+{
+    if (! this->isOpened()) {
+        return false;
+    }
+
+    if (! m_readBuffer.empty()) {
+        return true;
+    }
+
+    struct epoll_event event;
+    int                ret = ::epoll_wait(m_epollFd, &event, 1,
+                         static_cast<int>(timeout.count()));
+    if (ret < 0) {
+        int err = errno;
+        if (err != EINTR) {
             char errBuf[256];
-            int  err = errno;
-            qWarning() << "Read failed with errno " << err << " : "
+            qWarning() << "Epoll_wait failed with errno " << err << " : "
                        << ::strerror_r(err, errBuf, sizeof(errBuf)) << ".";
-            return -1;
-        } else {
-            sizeRead += static_cast<size_t>(readRet);
         }
+        return false;
+    }
 
-        // Time remain.
-        auto now = ::std::chrono::steady_clock::now();
-        if (now < endTime) {
-            timeRemain
-                = ::std::chrono::duration_cast<::std::chrono::milliseconds>(
-                    endTime - now);
-        } else {
-            return static_cast<ssize_t>(sizeRead);
-        }
+    if (ret > 0 && (event.events & (EPOLLHUP | EPOLLERR))) {
+        // Hung up or failed, epoll keeps reporting it, the read following
+        // fails instead of waiting again.
+        qWarning() << "Serial port hung up or failed.";
     }
 
-    return static_cast<ssize_t>(size);
+    return ret > 0;
+}
+
+/**
+ * @brief       Read bytes available without blocking.
+ */
+ssize_t Serial::readAvailable(void *buffer, size_t size)
+{
+    if (! this->isOpened()) {
+        return -1;
+    }
+
+    if (m_readBuffer.empty() && ! this->fillReadBuffer()) {
+        return -1;
+    }
+
+    size_t sizeRead = ::std::min(size, m_readBuffer.size());
+    ::std::copy(m_readBuffer.begin(), m_readBuffer.begin() + sizeRead,
+                reinterpret_cast<uint8_t *>(buffer));
+    m_readBuffer.erase(m_readBuffer.begin(), m_readBuffer.begin() + sizeRead);
+
+    return static_cast<ssize_t>(sizeRead);
 }
 
 /**
@@ -359,8 +575,17 @@ ssize_t Serial::write(const void *data, size_t size)
         ssize_t ret
             = ::write(m_nativeHandle, p + sizeWritten, size - sizeWritten);
         if (ret < 0) {
+            int err = errno;
+            if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR) {
+                // Output buffer is full, wait.
+                struct pollfd pollFd;
+                pollFd.fd     = m_nativeHandle;
+                pollFd.events = POLLOUT;
+                ::poll(&pollFd, 1, -1);
+                continue;
+            }
+
             char errBuf[256];
-            int  err = errno;
             qWarning() << "Write failed with errno " << err << " : "
                        << ::strerror_r(err, errBuf, sizeof(errBuf)) << ".";
             return -1;
@@ -379,6 +604,7 @@ void Serial::clearRead()
 {
     if (this->isOpened()) {
         ::tcflush(m_nativeHandle, TCIFLUSH);
+        m_readBuffer.clear();
     }
 }
 
@@ -387,10 +613,44 @@ void Serial::clearRead()
  */
 Serial::~Serial()
 {
-    if (this->isOpened()) {
-        ::close(m_nativeHandle);
-        m_nativeHandle = -1;
-        m_name         = "";
+    this->close();
+}
+
+/**
+ * @brief       Read all bytes available into read buffer.
+ */
+bool Serial::fillReadBuffer()
+{
+    while (true) {
+        size_t oldSize = m_readBuffer.size();
+        m_readBuffer.resize(oldSize + READ_CHUNK_SIZE);
+        ssize_t ret = ::read(m_nativeHandle, m_readBuffer.data() + oldSize,
+                             READ_CHUNK_SIZE);
+        if (ret < 0) {
+            m_readBuffer.resize(oldSize);
+            int err = errno;
+            if (err == EAGAIN || err == EWOULDBLOCK || err == EINTR) {
+                return true;
+            }
+
+            char errBuf[256];
+            qWarning() << "Read failed with errno " << err << " : "
+                       << ::strerror_r(err, errBuf, sizeof(errBuf)) << ".";
+            return false;
+        }
+
+        if (ret == 0) {
+            // End of file, the device has been removed.
+            m_readBuffer.resize(oldSize);
+            qWarning() << "Read failed, serial port hung up.";
+            return false;
+        }
+
+        // A short read means no more data available.
+        m_readBuffer.resize(oldSize + static_cast<size_t>(ret));
+        if (static_cast<size_t>(ret) < READ_CHUNK_SIZE) {
+            return true;
+        }
     }
 }
 
@@ -1,4 +1,3 @@
-#include <QtCore/QTimer>
 #include <QtWidgets/QGridLayout>
 #include <QtWidgets/QLabel>
 
@@ -12,7 +11,7 @@ GenericOperationWidget::GenericOperationWidget(QWidget *        parent,
                                                StringTable *    stringTable) :
     QWidget(parent),
     m_boardController(boardController), m_stringTable(stringTable),
-    m_updateSpeed(false), m_updateBootTime(false)
+    m_updateSpeed(false), m_updateBootTime(false), m_updatePWM(false)
 {
     QGridLayout *layout = new QGridLayout();
     this->setLayout(layout);
@@ -56,6 +55,63 @@ GenericOperationWidget::GenericOperationWidget(QWidget *        parent,
     m_txtBootTime->setReadOnly(true);
     layout->addWidget(new QLabel("μs"), 1, 5);
 
+    // Input PWM.
+    m_btnStartStopGetPWM = new QPushButton(
+        m_stringTable->getString("STR_BTN_START_READING_INPUT_PWM"));
+    layout->addWidget(m_btnStartStopGetPWM, 2, 0);
+    m_btnStartStopGetPWM->setEnabled(false);
+    this->connect(m_btnStartStopGetPWM, &QPushButton::clicked, this,
+                  &GenericOperationWidget::onBtnStartGetPWMClicked);
+
+    layout->addWidget(
+        new QLabel(m_stringTable->getString("STR_LABEL_INPUT_PWM")), 2, 1);
+
+    m_txtPWMDutyCycle = new QLineEdit("0");
+    layout->addWidget(m_txtPWMDutyCycle, 2, 2);
+    m_txtPWMDutyCycle->setReadOnly(true);
+
+    layout->addWidget(new QLabel("%"), 2, 3);
+
+    m_txtPWMFrequency = new QLineEdit("0");
+    layout->addWidget(m_txtPWMFrequency, 2, 4);
+    m_txtPWMFrequency->setReadOnly(true);
+
+    layout->addWidget(new QLabel("Hz"), 2, 5);
+
+    // Speed method.
+    layout->addWidget(
+        new QLabel(m_stringTable->getString("STR_LABEL_SPEED_METHOD")), 3, 1);
+
+    m_comboSpeedMethod = new QComboBox();
+    layout->addWidget(m_comboSpeedMethod, 3, 2, 1, 3);
+    m_comboSpeedMethod->addItems(
+        {m_stringTable->getString("STR_SPEED_METHOD_PERIOD"),
+         m_stringTable->getString("STR_SPEED_METHOD_COUNTING")});
+    m_comboSpeedMethod->setItemData(0,
+                                    static_cast<quint8>(SpeedMethod::Period));
+    m_comboSpeedMethod->setItemData(
+        1, static_cast<quint8>(SpeedMethod::Counting));
+    m_comboSpeedMethod->setCurrentIndex(0);
+    m_comboSpeedMethod->setEnabled(false);
+    this->connect(m_comboSpeedMethod,
+                  QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+                  &GenericOperationWidget::onSpeedMethodChanged);
+
+    // Speed window.
+    layout->addWidget(
+        new QLabel(m_stringTable->getString("STR_LABEL_SPEED_WINDOW")), 4, 1);
+
+    m_spinSpeedWindow = new QSpinBox();
+    layout->addWidget(m_spinSpeedWindow, 4, 2, 1, 3);
+    m_spinSpeedWindow->setRange(SPEED_SUB_WINDOW_MS, SPEED_WINDOW_MAX_MS);
+    m_spinSpeedWindow->setSingleStep(SPEED_SUB_WINDOW_MS);
+    m_spinSpeedWindow->setValue(SPEED_WINDOW_DEFAULT_MS);
+    m_spinSpeedWindow->setSuffix(" ms");
+    m_spinSpeedWindow->setEnabled(false);
+    this->connect(m_spinSpeedWindow,
+                  QOverload<int>::of(&QSpinBox::valueChanged), this,
+                  &GenericOperationWidget::onSpeedWindowChanged);
+
     layout->setColumnStretch(0, 0);
     layout->setColumnStretch(1, 0);
     layout->setColumnStretch(2, 100);
@@ -63,29 +119,23 @@ GenericOperationWidget::GenericOperationWidget(QWidget *        parent,
     layout->setColumnStretch(4, 100);
     layout->setColumnStretch(5, 0);
 
-    // Timer.
-    m_updateTimer = new QTimer(this);
-    m_updateTimer->setSingleShot(false);
-    m_updateTimer->setInterval(1000);
-    m_updateTimer->stop();
-    this->connect(m_updateTimer, &QTimer::timeout, this,
-                  &GenericOperationWidget::onTimer);
-
     // Connect.
-    this->connect(m_boardController, &BoardController::speedUpdated, this,
-                  &GenericOperationWidget::onSpeedUpdated,
-                  Qt::QueuedConnection);
-    this->connect(m_boardController, &BoardController::clockUpdated, this,
-                  &GenericOperationWidget::onClockUpdated,
-                  Qt::QueuedConnection);
     this->connect(m_boardController, &BoardController::opened, this,
                   &GenericOperationWidget::onOpened, Qt::QueuedConnection);
     this->connect(m_boardController, &BoardController::closed, this,
                   &GenericOperationWidget::onClosed, Qt::QueuedConnection);
-    this->connect(this, &GenericOperationWidget::updateSpeed, m_boardController,
-                  &BoardController::updateSpeed, Qt::QueuedConnection);
-    this->connect(this, &GenericOperationWidget::updateClock, m_boardController,
-                  &BoardController::updateClock, Qt::QueuedConnection);
+    this->connect(m_boardController, &BoardController::telemetryUpdated, this,
+                  &GenericOperationWidget::onTelemetryUpdated,
+                  Qt::QueuedConnection);
+    this->connect(this, &GenericOperationWidget::subscribeTelemetry,
+                  m_boardController, &BoardController::subscribeTelemetry,
+                  Qt::QueuedConnection);
+    this->connect(this, &GenericOperationWidget::setSpeedMethod,
+                  m_boardController, &BoardController::setSpeedMethod,
+                  Qt::QueuedConnection);
+    this->connect(this, &GenericOperationWidget::setSpeedWindow,
+                  m_boardController, &BoardController::setSpeedWindow,
+                  Qt::QueuedConnection);
 }
 
 /**
@@ -98,9 +148,14 @@ GenericOperationWidget::~GenericOperationWidget() {}
  */
 void GenericOperationWidget::onOpened()
 {
-    m_updateTimer->start();
     m_btnStartStopGetSpeed->setEnabled(true);
     m_btnStartStopGetBootTime->setEnabled(true);
+    m_btnStartStopGetPWM->setEnabled(true);
+    m_comboSpeedMethod->setEnabled(true);
+    this->onSpeedMethodChanged(m_comboSpeedMethod->currentIndex());
+    m_spinSpeedWindow->setEnabled(true);
+    this->onSpeedWindowChanged(m_spinSpeedWindow->value());
+    this->updateSubscription();
 }
 
 /**
@@ -108,9 +163,11 @@ void GenericOperationWidget::onOpened()
  */
 void GenericOperationWidget::onClosed()
 {
-    m_updateTimer->stop();
     m_btnStartStopGetSpeed->setEnabled(false);
     m_btnStartStopGetBootTime->setEnabled(false);
+    m_btnStartStopGetPWM->setEnabled(false);
+    m_comboSpeedMethod->setEnabled(false);
+    m_spinSpeedWindow->setEnabled(false);
 }
 
 /**
@@ -124,6 +181,7 @@ void GenericOperationWidget::onBtnStartGetSpeedClicked()
     this->disconnect(m_btnStartStopGetSpeed);
     this->connect(m_btnStartStopGetSpeed, &QPushButton::clicked, this,
                   &GenericOperationWidget::onBtnStopGetSpeedClicked);
+    this->updateSubscription();
 }
 
 /**
@@ -137,6 +195,7 @@ void GenericOperationWidget::onBtnStopGetSpeedClicked()
     this->disconnect(m_btnStartStopGetSpeed);
     this->connect(m_btnStartStopGetSpeed, &QPushButton::clicked, this,
                   &GenericOperationWidget::onBtnStartGetSpeedClicked);
+    this->updateSubscription();
 }
 
 /**
@@ -150,6 +209,7 @@ void GenericOperationWidget::onBtnStartGetBootTimeClicked()
     this->disconnect(m_btnStartStopGetBootTime);
     this->connect(m_btnStartStopGetBootTime, &QPushButton::clicked, this,
                   &GenericOperationWidget::onBtnStopGetBootTimeClicked);
+    this->updateSubscription();
 }
 
 /**
@@ -163,35 +223,88 @@ void GenericOperationWidget::onBtnStopGetBootTimeClicked()
     this->disconnect(m_btnStartStopGetBootTime);
     this->connect(m_btnStartStopGetBootTime, &QPushButton::clicked, this,
                   &GenericOperationWidget::onBtnStartGetBootTimeClicked);
+    this->updateSubscription();
 }
 
 /**
- * @brief       On timer.
+ * @brief       On button start get input PWM clicked.
  */
-void GenericOperationWidget::onTimer()
+void GenericOperationWidget::onBtnStartGetPWMClicked()
 {
-    if (m_updateSpeed) {
-        emit this->updateSpeed();
-    }
-    if (m_updateBootTime) {
-        emit this->updateClock();
-    }
+    m_updatePWM = true;
+    m_btnStartStopGetPWM->setText(
+        m_stringTable->getString("STR_BTN_STOP_READING_INPUT_PWM"));
+    this->disconnect(m_btnStartStopGetPWM);
+    this->connect(m_btnStartStopGetPWM, &QPushButton::clicked, this,
+                  &GenericOperationWidget::onBtnStopGetPWMClicked);
+    this->updateSubscription();
+}
+
+/**
+ * @brief       On button stop get input PWM clicked.
+ */
+void GenericOperationWidget::onBtnStopGetPWMClicked()
+{
+    m_updatePWM = false;
+    m_btnStartStopGetPWM->setText(
+        m_stringTable->getString("STR_BTN_START_READING_INPUT_PWM"));
+    this->disconnect(m_btnStartStopGetPWM);
+    this->connect(m_btnStartStopGetPWM, &QPushButton::clicked, this,
+                  &GenericOperationWidget::onBtnStartGetPWMClicked);
+    this->updateSubscription();
+}
+
+/**
+ * @brief       On speed method changed.
+ */
+void GenericOperationWidget::onSpeedMethodChanged(int index)
+{
+    emit this->setSpeedMethod(static_cast<SpeedMethod>(
+        m_comboSpeedMethod->itemData(index).toUInt()));
 }
 
 /**
- * @brief       Firmware mode signal.
+ * @brief       On speed window changed.
  */
-void GenericOperationWidget::onSpeedUpdated(quint16 speed)
+void GenericOperationWidget::onSpeedWindowChanged(int window)
 {
-    m_txtSpeedHz->setText(QString("%1").arg(speed));
-    m_txtSpeedRPM->setText(
-        QString("%1").arg(static_cast<quint64>(speed) / 2 * 60));
+    // Round to whole sub-windows, the firmware rejects the others.
+    window -= window % SPEED_SUB_WINDOW_MS;
+    emit this->setSpeedWindow(static_cast<quint16>(window));
 }
 
 /**
- * @brief       Firmware mode signal.
+ * @brief       Telemetry signal.
  */
-void GenericOperationWidget::onClockUpdated(quint32 time)
+void GenericOperationWidget::onTelemetryUpdated(quint16 speed,
+                                                quint8  dutyCycle,
+                                                quint16 frequency,
+                                                quint32 time)
 {
-    m_txtBootTime->setText(QString("%1").arg(time));
+    if (m_updateSpeed) {
+        m_txtSpeedHz->setText(QString("%1").arg(speed));
+        m_txtSpeedRPM->setText(
+            QString("%1").arg(static_cast<quint64>(speed) / 2 * 60));
+    }
+    if (m_updateBootTime) {
+        m_txtBootTime->setText(QString("%1").arg(time));
+    }
+    if (m_updatePWM) {
+        m_txtPWMDutyCycle->setText(QString("%1").arg(dutyCycle));
+        m_txtPWMFrequency->setText(QString("%1").arg(frequency));
+    }
+}
+
+/**
+ * @brief       Subscribe telemetry if speed, boot time or input PWM is being
+ *              read, otherwise unsubscribe.
+ */
+void GenericOperationWidget::updateSubscription()
+{
+    // Pushed every 100ms, speed, input PWM and boot time in one frame.
+    if (m_updateSpeed || m_updateBootTime || m_updatePWM) {
+        emit this->subscribeTelemetry(100);
+    } else {
+        emit this->subscribeTelemetry(0);
+    }
 }
@@ -36,10 +36,15 @@ MainWindow::MainWindow() :
 
     m_messageWidget = new MessageWidget(this, m_stringTable);
     layout->addWidget(m_messageWidget);
-    m_boardController->connect(m_boardController, &BoardController::printInfo,
-                               m_messageWidget, &MessageWidget::onPrintInfo);
-    m_boardController->connect(m_boardController, &BoardController::printError,
-                               m_messageWidget, &MessageWidget::onPrintError);
+    m_boardController->connect(m_boardController, &BoardController::traced,
+                               m_messageWidget, &MessageWidget::onTraced,
+                               Qt::QueuedConnection);
+    m_boardController->connect(
+        m_messageWidget, &MessageWidget::traceLevelChanged, m_boardController,
+        &BoardController::setTraceLevel, Qt::QueuedConnection);
+    m_boardController->connect(
+        m_messageWidget, &MessageWidget::saveStatistics, m_boardController,
+        &BoardController::saveStatistics, Qt::QueuedConnection);
 }
 
 /**
@@ -1,3 +1,6 @@
+#include <QtWidgets/QGridLayout>
+#include <QtWidgets/QLabel>
+
 #include <view/manual_mode_operation_widget.h>
 
 /**
@@ -9,6 +12,46 @@ ManualModeWidget::ManualModeWidget(QWidget *        parent,
     QWidget(parent),
     m_boardController(boardController), m_stringTable(stringTable)
 {
+    QGridLayout *layout = new QGridLayout();
+    this->setLayout(layout);
+
+    // Output speed.
+    QLabel *label
+        = new QLabel(m_stringTable->getString("STR_LABEL_OUTPUT_SPEED"));
+    layout->addWidget(label, 0, 0);
+
+    m_spinOutputSpeed = new QSpinBox();
+    layout->addWidget(m_spinOutputSpeed, 0, 1);
+    m_spinOutputSpeed->setRange(0, 65535);
+    m_spinOutputSpeed->setSuffix(" Hz");
+
+    m_btnSetOutputSpeed
+        = new QPushButton(m_stringTable->getString("STR_BTN_SET"));
+    layout->addWidget(m_btnSetOutputSpeed, 0, 2);
+    this->connect(m_btnSetOutputSpeed, &QPushButton::clicked, this,
+                  &ManualModeWidget::onBtnSetOutputSpeedClicked);
+
+    // Output PWM.
+    label = new QLabel(m_stringTable->getString("STR_LABEL_OUTPUT_PWM"));
+    layout->addWidget(label, 1, 0);
+
+    m_spinOutputPWM = new QSpinBox();
+    layout->addWidget(m_spinOutputPWM, 1, 1);
+    m_spinOutputPWM->setRange(0, 100);
+    m_spinOutputPWM->setSuffix("%");
+    m_spinOutputPWM->setValue(100);
+
+    m_btnSetOutputPWM
+        = new QPushButton(m_stringTable->getString("STR_BTN_SET"));
+    layout->addWidget(m_btnSetOutputPWM, 1, 2);
+    this->connect(m_btnSetOutputPWM, &QPushButton::clicked, this,
+                  &ManualModeWidget::onBtnSetOutputPWMClicked);
+
+    layout->setColumnStretch(0, 0);
+    layout->setColumnStretch(1, 0);
+    layout->setColumnStretch(2, 0);
+    layout->setColumnStretch(3, 100);
+
     // Connect signals.
     this->connect(m_boardController, &BoardController::opened, this,
                   &ManualModeWidget::onOpened, Qt::QueuedConnection);
@@ -17,6 +60,10 @@ ManualModeWidget::ManualModeWidget(QWidget *        parent,
     this->connect(m_boardController, &BoardController::firmwareModeUpdated,
                   this, &ManualModeWidget::onFirmwareModeUpdated,
                   Qt::QueuedConnection);
+    this->connect(this, &ManualModeWidget::setOutputSpeed, m_boardController,
+                  &BoardController::setOutputSpeed, Qt::QueuedConnection);
+    this->connect(this, &ManualModeWidget::setOutputPWM, m_boardController,
+                  &BoardController::setOutputPWM, Qt::QueuedConnection);
 
     this->setVisible(false);
 }
@@ -39,6 +86,22 @@ void ManualModeWidget::onClosed()
     this->setVisible(false);
 }
 
+/**
+ * @brief       On button set output speed clicked.
+ */
+void ManualModeWidget::onBtnSetOutputSpeedClicked()
+{
+    emit this->setOutputSpeed((quint16)(m_spinOutputSpeed->value()));
+}
+
+/**
+ * @brief       On button set output PWM clicked.
+ */
+void ManualModeWidget::onBtnSetOutputPWMClicked()
+{
+    emit this->setOutputPWM((quint8)(m_spinOutputPWM->value()));
+}
+
 /**
  * @brief       Firmware mode updated.
  */
@@ -1,4 +1,6 @@
+#include <QtWidgets/QFileDialog>
 #include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QLabel>
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QVBoxLayout>
 
@@ -8,7 +10,9 @@
  * @brief       Constructor.
  */
 MessageWidget::MessageWidget(QWidget *parent, StringTable *stringTable) :
-    QWidget(parent), m_stringTable(stringTable)
+    QWidget(parent), m_stringTable(stringTable),
+    m_baseTime(QDateTime::currentDateTime()),
+    m_baseSteadyTime(::std::chrono::steady_clock::now())
 {
     QVBoxLayout *layout = new QVBoxLayout();
     this->setLayout(layout);
@@ -18,10 +22,41 @@ MessageWidget::MessageWidget(QWidget *parent, StringTable *stringTable) :
     QPushButton *button
         = new QPushButton(m_stringTable->getString("STR_BTN_CLEAR"));
     btnLayout->addWidget(button);
-    btnLayout->addStretch();
     this->connect(button, &QPushButton::clicked, this,
                   &MessageWidget::onBtnClearClicked);
 
+    button
+        = new QPushButton(m_stringTable->getString("STR_BTN_SAVE_STATISTICS"));
+    btnLayout->addWidget(button);
+    btnLayout->addStretch();
+    this->connect(button, &QPushButton::clicked, this,
+                  &MessageWidget::onBtnSaveStatisticsClicked);
+
+    QLabel *label
+        = new QLabel(m_stringTable->getString("STR_LABEL_TRACE_LEVEL"));
+    btnLayout->addWidget(label);
+    m_comboTraceLevel = new QComboBox();
+    btnLayout->addWidget(m_comboTraceLevel);
+    m_comboTraceLevel->setEditable(false);
+    m_comboTraceLevel->addItem(m_stringTable->getString("STR_TRACE_LEVEL_OFF"),
+                               static_cast<int>(TraceLevel::Off));
+    m_comboTraceLevel->addItem(
+        m_stringTable->getString("STR_TRACE_LEVEL_ERRORS"),
+        static_cast<int>(TraceLevel::Errors));
+    m_comboTraceLevel->addItem(
+        m_stringTable->getString("STR_TRACE_LEVEL_SUMMARY"),
+        static_cast<int>(TraceLevel::Summary));
+    m_comboTraceLevel->addItem(
+        m_stringTable->getString("STR_TRACE_LEVEL_VERBOSE"),
+        static_cast<int>(TraceLevel::Verbose));
+    m_comboTraceLevel->addItem(m_stringTable->getString("STR_TRACE_LEVEL_HEX"),
+                               static_cast<int>(TraceLevel::Hex));
+    m_comboTraceLevel->setCurrentIndex(
+        m_comboTraceLevel->findData(static_cast<int>(TraceLevel::Summary)));
+    this->connect(m_comboTraceLevel,
+                  QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+                  &MessageWidget::onTraceLevelChanged);
+
     m_textEdit = new QTextEdit(this);
     layout->addWidget(m_textEdit);
     m_textEdit->setReadOnly(true);
@@ -43,23 +78,88 @@ void MessageWidget::onBtnClearClicked()
 }
 
 /**
- * @brief       Print info message.
+ * @brief       On button save statistics clicked.
  */
-void MessageWidget::onPrintInfo(QDateTime time, QString message)
+void MessageWidget::onBtnSaveStatisticsClicked()
 {
-    m_textEdit->append(m_stringTable->getString("STR_MESSAGE_INFO")
-                           .arg(time.toString("yyyy-MM-dd hh:mm:ss.zzz"))
-                           .arg(message));
-    this->m_textEdit->moveCursor(QTextCursor::End);
+    QString fileName = QFileDialog::getSaveFileName(
+        this, m_stringTable->getString("STR_BTN_SAVE_STATISTICS"), "",
+        "CSV (*.csv)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    emit this->saveStatistics(fileName);
 }
 
 /**
- * @brief       Print error message.
+ * @brief       On trace level changed.
  */
-void MessageWidget::onPrintError(QDateTime time, QString message)
+void MessageWidget::onTraceLevelChanged(int index)
 {
-    m_textEdit->append(m_stringTable->getString("STR_MESSAGE_ERROR")
-                           .arg(time.toString("yyyy-MM-dd hh:mm:ss.zzz"))
-                           .arg(message));
+    emit this->traceLevelChanged(static_cast<TraceLevel>(
+        m_comboTraceLevel->itemData(index).toInt()));
+}
+
+/**
+ * @brief       Print trace record.
+ */
+void MessageWidget::onTraced(TraceRecord record)
+{
+    // Map the monotonic time to wall time.
+    QDateTime time = m_baseTime.addMSecs(
+        ::std::chrono::duration_cast<::std::chrono::milliseconds>(
+            record.time - m_baseSteadyTime)
+            .count());
+
+    QString message;
+    switch (record.type) {
+        case TraceType::Error:
+        case TraceType::Info:
+            message = m_stringTable->getString(record.stringId);
+            for (const QString &arg : record.args) {
+                message = message.arg(arg);
+            }
+            break;
+
+        case TraceType::Command:
+            if (record.level == TraceLevel::Hex) {
+                message
+                    = m_stringTable->getString("STR_MESSAGE_COMMAND_SEND")
+                          .arg(QString::fromUtf8(
+                              record.data.toHex(' ').toUpper()));
+            } else {
+                message
+                    = m_stringTable
+                          ->getString("STR_MESSAGE_COMMAND_SEND_SUMMARY")
+                          .arg(QString::number(record.dataType, 16)
+                                   .rightJustified(2, '0')
+                                   .toUpper())
+                          .arg(static_cast<qulonglong>(record.size));
+            }
+            break;
+
+        case TraceType::Reply:
+            if (record.level == TraceLevel::Hex) {
+                message = m_stringTable->getString("STR_MESSAGE_REPLY")
+                              .arg(QString::fromUtf8(
+                                  record.data.toHex(' ').toUpper()));
+            } else {
+                message
+                    = m_stringTable->getString("STR_MESSAGE_REPLY_SUMMARY")
+                          .arg(QString::number(record.dataType, 16)
+                                   .rightJustified(2, '0')
+                                   .toUpper())
+                          .arg(static_cast<qulonglong>(record.size));
+            }
+            break;
+    }
+
+    m_textEdit->append(
+        m_stringTable
+            ->getString(record.type == TraceType::Error ? "STR_MESSAGE_ERROR"
+                                                        : "STR_MESSAGE_INFO")
+            .arg(time.toString("yyyy-MM-dd hh:mm:ss.zzz"))
+            .arg(message));
     this->m_textEdit->moveCursor(QTextCursor::End);
 }
@@ -23,7 +23,8 @@ SerialWidget::SerialWidget(QWidget *        parent,
 
     m_comboSerial = new QComboBox();
     layout->addWidget(m_comboSerial, 0, 1);
-    m_comboSerial->setEditable(false);
+    // Editable to open the ports not listed, such as "pts/N" of simulator.
+    m_comboSerial->setEditable(true);
 
     m_btnOpenClose = new QPushButton(m_stringTable->getString("STR_BTN_OPEN"));
     layout->addWidget(m_btnOpenClose, 0, 2);
@@ -36,6 +37,24 @@ SerialWidget::SerialWidget(QWidget *        parent,
                   &SerialWidget::onBtnRefreshClicked);
     this->onBtnRefreshClicked();
 
+    label = new QLabel(m_stringTable->getString("STR_LABEL_BAUD_RATE"));
+    layout->addWidget(label, 1, 0);
+
+    m_comboBaudRate = new QComboBox();
+    layout->addWidget(m_comboBaudRate, 1, 1);
+    m_comboBaudRate->setEditable(false);
+    for (quint32 baudRate : Serial::BAUD_RATES) {
+        m_comboBaudRate->addItem(QString("%1").arg(baudRate), baudRate);
+    }
+    m_comboBaudRate->setCurrentIndex(0);
+    m_comboBaudRate->setEnabled(false);
+
+    m_btnSetBaudRate = new QPushButton(m_stringTable->getString("STR_BTN_SET"));
+    layout->addWidget(m_btnSetBaudRate, 1, 2);
+    m_btnSetBaudRate->setEnabled(false);
+    this->connect(m_btnSetBaudRate, &QPushButton::clicked, this,
+                  &SerialWidget::onBtnSetBaudRateClicked);
+
     layout->setColumnStretch(0, 0);
     layout->setColumnStretch(1, 100);
     layout->setColumnStretch(2, 0);
@@ -51,6 +70,10 @@ SerialWidget::SerialWidget(QWidget *        parent,
                   &BoardController::open, Qt::QueuedConnection);
     this->connect(this, &SerialWidget::close, m_boardController,
                   &BoardController::close, Qt::QueuedConnection);
+    this->connect(m_boardController, &BoardController::baudRateUpdated, this,
+                  &SerialWidget::onBaudRateUpdated, Qt::QueuedConnection);
+    this->connect(this, &SerialWidget::setBaudRate, m_boardController,
+                  &BoardController::setBaudRate, Qt::QueuedConnection);
 }
 
 /**
@@ -69,6 +92,10 @@ void SerialWidget::onOpened()
                   &SerialWidget::onBtnCloseClicked);
     m_btnOpenClose->setEnabled(true);
     m_btnRefresh->setEnabled(false);
+    m_comboBaudRate->setCurrentIndex(
+        m_comboBaudRate->findData(SERIAL_DEFAULT_BAUD_RATE));
+    m_comboBaudRate->setEnabled(true);
+    m_btnSetBaudRate->setEnabled(true);
 }
 
 /**
@@ -82,6 +109,8 @@ void SerialWidget::onClosed()
                   &SerialWidget::onBtnOpenClicked);
     m_btnOpenClose->setEnabled(true);
     m_btnRefresh->setEnabled(true);
+    m_comboBaudRate->setEnabled(false);
+    m_btnSetBaudRate->setEnabled(false);
 }
 
 /**
@@ -129,3 +158,24 @@ void SerialWidget::onBtnRefreshClicked()
         m_btnOpenClose->setEnabled(false);
     }
 }
+
+/**
+ * @brief       On button set baud rate clicked.
+ */
+void SerialWidget::onBtnSetBaudRateClicked()
+{
+    m_comboBaudRate->setEnabled(false);
+    m_btnSetBaudRate->setEnabled(false);
+    emit this->setBaudRate(m_comboBaudRate->currentData().toUInt());
+}
+
+/**
+ * @brief       Baud rate updated.
+ */
+void SerialWidget::onBaudRateUpdated(bool success, quint32 baudRate)
+{
+    Q_UNUSED(success);
+    m_comboBaudRate->setCurrentIndex(m_comboBaudRate->findData(baudRate));
+    m_comboBaudRate->setEnabled(true);
+    m_btnSetBaudRate->setEnabled(true);
+}
@@ -10,12 +10,25 @@
     #endif
 #endif
 
-#if ! defined BUILD_FIRMWARE
+#if ! defined BUILD_FIRMWARE || defined BUILD_SIMULATOR
     #pragma pack(push, 1)
 #endif
 
-/// Begining of the command.
-#define CMD_BEGIN ((uint8_t)0xFF)
+/// Begining of the frame.
+#define FRAME_BEGIN ((uint8_t)0xA5)
+
+/// Max size of the payload of a frame.
+#define FRAME_PAYLOAD_MAX_SIZE ((uint8_t)32)
+
+/// Max number of commands in flight, must be a power of 2.
+#define FRAME_WINDOW_SIZE ((uint8_t)4)
+
+/// Sequence number of the frames pushed by firmware without command.
+#define FRAME_SEQUENCE_PUSH ((uint8_t)0x00)
+
+/// CRC-8 polynomial(x^8 + x^2 + x + 1) and initial value of the frame check.
+#define FRAME_CRC_POLY ((uint8_t)0x07)
+#define FRAME_CRC_INIT ((uint8_t)0xFF)
 
 /// Mode command.
 #define CMD_TYPE_GET_MODE ((uint8_t)0x00)
@@ -37,20 +50,50 @@
 #define PORT_WRITE_PWM_OUTPUT   ((uint8_t)0x01)
 
 // Status monitor command.
-#define CMD_TYPE_GET_INPUT_SPEED ((uint8_t)0x20)
-#define CMD_TYPE_GET_INPUT_PWM   ((uint8_t)0x21)
+#define CMD_TYPE_GET_INPUT_SPEED     ((uint8_t)0x20)
+#define CMD_TYPE_GET_INPUT_PWM       ((uint8_t)0x21)
+#define CMD_TYPE_GET_TELEMETRY       ((uint8_t)0x22)
+#define CMD_TYPE_SUBSCRIBE_TELEMETRY ((uint8_t)0x23)
+#define CMD_TYPE_SET_SPEED_METHOD    ((uint8_t)0x24)
+#define CMD_TYPE_SET_SPEED_WINDOW    ((uint8_t)0x25)
+
+/// Method to measure input speed.
+#define SPEED_METHOD_PERIOD   ((uint8_t)0x00)
+#define SPEED_METHOD_COUNTING ((uint8_t)0x01)
+
+/// Window of counting edges(ms), made of sub-windows, the speed is updated
+/// at the end of each sub-window.
+#define SPEED_SUB_WINDOW_MS     ((uint16_t)50)
+#define SPEED_WINDOW_MAX_MS     ((uint16_t)1000)
+#define SPEED_WINDOW_DEFAULT_MS ((uint16_t)500)
 
 /// Fan test command, manual mode only.
 #define CMD_TYPE_SET_OUTPUT_SPEED ((uint8_t)0x30)
 #define CMD_TYPE_SET_OUTPUT_PWM   ((uint8_t)0x31)
 
-/// Config.
-#define CMD_TYPE_READ_CONFIG  ((uint8_t)0x40)
-#define CMD_TYPE_WRITE_CONFIG ((uint8_t)0x41)
+/// Config, transferred in chunks, written chunks take effect after commit.
+#define CMD_TYPE_READ_CONFIG   ((uint8_t)0x40)
+#define CMD_TYPE_WRITE_CONFIG  ((uint8_t)0x41)
+#define CMD_TYPE_COMMIT_CONFIG ((uint8_t)0x42)
+
+/// Max size of the data of a config chunk.
+#define CONFIG_CHUNK_MAX_SIZE ((uint8_t)16)
 
 /// Read clock.
 #define CMD_TYPE_READ_CLOCK ((uint8_t)0x50)
 
+/// Serial.
+#define CMD_TYPE_SET_BAUD_RATE ((uint8_t)0x60)
+
+/// Baud rate after reset, the firmware falls back to it if the link is not
+/// confirmed in SERIAL_LINK_CHECK_TIMEOUT_MS after switching baud rate.
+#define SERIAL_DEFAULT_BAUD_RATE ((uint32_t)9600)
+#define SERIAL_MAX_BAUD_RATE     ((uint32_t)115200)
+
+/// The link at new baud rate is confirmed by a frame received after a reply
+/// has been sent at the new baud rate, so the host has received it.
+#define SERIAL_LINK_CHECK_TIMEOUT_MS 3000
+
 #define REPLY_TYPE_FAILED  ((uint8_t)0x00) ///< Command failed.
 #define REPLY_TYPE_SUCCESS ((uint8_t)0x01) ///< Success.
 
@@ -59,17 +102,23 @@
  * @brief       Command type.
  */
 enum class CMDType : uint8_t {
-    GetMode        = CMD_TYPE_GET_MODE,         ///< Get firmware mode.
-    SetMode        = CMD_TYPE_SET_MODE,         ///< Set firmware mode.
-    ReadPort       = CMD_TYPE_READ_PORT,        ///< Read output port.
-    WritePort      = CMD_TYPE_WRITE_PORT,       ///< Write input port.
-    GetInputSpeed  = CMD_TYPE_GET_INPUT_SPEED,  ///< Get input fan speed.
-    GetInputPWM    = CMD_TYPE_GET_INPUT_PWM,    ///< Get input pwm.
-    SetOutputSpeed = CMD_TYPE_SET_OUTPUT_SPEED, ///< Set output speed.
-    SetOutputPWM   = CMD_TYPE_SET_OUTPUT_PWM,   ///< Set output pwm.
-    ReacConfig     = CMD_TYPE_READ_CONFIG,      ///< Read config.
-    WriteConfig    = CMD_TYPE_WRITE_CONFIG,     ///< Write config.
-    ReadClock      = CMD_TYPE_READ_CLOCK        ///< Read clock.
+    GetMode            = CMD_TYPE_GET_MODE,            ///< Get firmware mode.
+    SetMode            = CMD_TYPE_SET_MODE,            ///< Set firmware mode.
+    ReadPort           = CMD_TYPE_READ_PORT,           ///< Read output port.
+    WritePort          = CMD_TYPE_WRITE_PORT,          ///< Write input port.
+    GetInputSpeed      = CMD_TYPE_GET_INPUT_SPEED,     ///< Get input fan speed.
+    GetInputPWM        = CMD_TYPE_GET_INPUT_PWM,       ///< Get input pwm.
+    GetTelemetry       = CMD_TYPE_GET_TELEMETRY,       ///< Get telemetry.
+    SubscribeTelemetry = CMD_TYPE_SUBSCRIBE_TELEMETRY, ///< Push telemetry.
+    SetSpeedMethod     = CMD_TYPE_SET_SPEED_METHOD,    ///< Set speed method.
+    SetSpeedWindow     = CMD_TYPE_SET_SPEED_WINDOW,    ///< Set speed window.
+    SetOutputSpeed     = CMD_TYPE_SET_OUTPUT_SPEED,    ///< Set output speed.
+    SetOutputPWM       = CMD_TYPE_SET_OUTPUT_PWM,      ///< Set output pwm.
+    ReadConfig         = CMD_TYPE_READ_CONFIG,         ///< Read config.
+    WriteConfig        = CMD_TYPE_WRITE_CONFIG,        ///< Write config.
+    CommitConfig       = CMD_TYPE_COMMIT_CONFIG,       ///< Commit config.
+    ReadClock          = CMD_TYPE_READ_CLOCK,          ///< Read clock.
+    SetBaudRate        = CMD_TYPE_SET_BAUD_RATE        ///< Set baud rate.
 };
 
 /**
@@ -97,6 +146,14 @@ enum class WritablePort : uint8_t {
     PWMOutput   = PORT_WRITE_PWM_OUTPUT    ///< PWM output.
 };
 
+/**
+ * @brief   Method to measure input speed.
+ */
+enum class SpeedMethod : uint8_t {
+    Period   = SPEED_METHOD_PERIOD,  ///< Period between edges.
+    Counting = SPEED_METHOD_COUNTING ///< Edges counted in a sliding window.
+};
+
 /**
  * @brief   Reply type.
  */
@@ -107,11 +164,72 @@ enum class ReplyType : uint8_t {
 
 #endif
 
+/**
+ * @brief       Frame header.
+ *
+ * A frame is laid out as :
+ *  | FrameHeader | payload(length bytes) | crc(1 byte) |
+ * The crc is computed over length, sequence and payload. The payload of a
+ * frame sent by host is a command, the payload of a frame sent by firmware is
+ * the reply of the command which has the same sequence number. Frames with
+ * sequence FRAME_SEQUENCE_PUSH are pushed by firmware after a
+ * SubscribeTelemetry command, the payload is a ReplyGetTelemetry.
+ */
+struct FrameHeader {
+    uint8_t begin;    ///< Value = FRAME_BEGIN.
+    uint8_t length;   ///< Size of payload.
+    uint8_t sequence; ///< Sequence number.
+};
+
+/**
+ * @brief       Update frame crc.
+ *
+ * @param[in]   crc     Current crc.
+ * @param[in]   byte    Byte to append.
+ *
+ * @return      New crc.
+ */
+static inline uint8_t frame_crc_update(uint8_t crc, uint8_t byte)
+{
+    crc ^= byte;
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (crc & 0x80) {
+            crc = (uint8_t)((uint8_t)(crc << 1) ^ FRAME_CRC_POLY);
+        } else {
+            crc = (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief       Compute crc of a config chunk.
+ *
+ * @param[in]   offset  Offset of the chunk in FirmwareConfig.
+ * @param[in]   length  Size of the chunk.
+ * @param[in]   data    Data of the chunk.
+ *
+ * @return      Crc over offset, length and data.
+ */
+static inline uint8_t config_chunk_crc(uint8_t        offset,
+                                       uint8_t        length,
+                                       const uint8_t *data)
+{
+    uint8_t crc = frame_crc_update(FRAME_CRC_INIT, offset);
+    crc         = frame_crc_update(crc, length);
+    for (uint8_t i = 0; i < length; ++i) {
+        crc = frame_crc_update(crc, data[i]);
+    }
+
+    return crc;
+}
+
 /**
  * @brief   Firmware config.
  */
 struct FirmwareConfig {
-    uint8_t pwmMap[10]; ///< 10% a stage, 0-100.
+    uint8_t pwmMap[10]; ///< Output at input 10%-100%, 10% a stage, 0-100.
     struct {
         uint16_t source; ///< Source speed(HZ).
         uint16_t dest;   ///< Dest speed(HZ).
@@ -122,7 +240,6 @@ struct FirmwareConfig {
  * @brief       Command header.
  */
 struct CMDHeader {
-    uint8_t cmdBegin; ///< Value = CMD_BEGIN.
 #if defined __cplusplus
     CMDType cmdType; ///< Command type.
 #else
@@ -188,6 +305,47 @@ struct CMDGetInputPWM {
     struct CMDHeader header; ///< Command header.
 };
 
+/**
+ * @brief       Command GetTelemetry.
+ */
+struct CMDGetTelemetry {
+    struct CMDHeader header; ///< Command header.
+};
+
+/**
+ * @brief       Command SubscribeTelemetry.
+ */
+struct CMDSubscribeTelemetry {
+    struct CMDHeader header;   ///< Command header.
+    uint16_t         interval; ///< Min interval of pushes(ms), 0 to stop.
+};
+
+/**
+ * @brief       Command SetSpeedMethod.
+ *
+ * The period between edges updates on every edge and is accurate at low
+ * speed, counting edges suits high speed.
+ */
+struct CMDSetSpeedMethod {
+    struct CMDHeader header; ///< Command header.
+#if defined __cplusplus
+    SpeedMethod method; ///< Method.
+#else
+    uint8_t method;     ///< Method.
+#endif
+};
+
+/**
+ * @brief       Command SetSpeedWindow.
+ *
+ * A longer window is less noisy, the speed is updated every
+ * SPEED_SUB_WINDOW_MS regardless of the window.
+ */
+struct CMDSetSpeedWindow {
+    struct CMDHeader header; ///< Command header.
+    uint16_t         window; ///< Window(ms), multiple of SPEED_SUB_WINDOW_MS.
+};
+
 /**
  * @brief       Command SetOutputSpeed.
  */
@@ -201,7 +359,7 @@ struct CMDSetOutputSpeed {
  */
 struct CMDSetOutputPWM {
     struct CMDHeader header;    ///< Command header.
-    uint8_t          dutyCycle; ///< Duty cycle, 1-100.
+    uint8_t          dutyCycle; ///< Duty cycle, 0-100.
 };
 
 /**
@@ -209,14 +367,31 @@ struct CMDSetOutputPWM {
  */
 struct CMDReadConfig {
     struct CMDHeader header; ///< Command header.
+    uint8_t          offset; ///< Offset of the chunk in FirmwareConfig.
+    uint8_t          length; ///< Size of the chunk.
 };
 
 /**
  * @brief       Command WriteConfig.
  */
 struct CMDWriteConfig {
-    struct CMDHeader      header; ///< Command header.
-    struct FirmwareConfig config; ///< Config.
+    struct CMDHeader header; ///< Command header.
+    uint8_t          offset; ///< Offset of the chunk in FirmwareConfig.
+    uint8_t          length; ///< Size of the chunk.
+    uint8_t          crc;    ///< config_chunk_crc() of the chunk.
+    uint8_t          data[CONFIG_CHUNK_MAX_SIZE]; ///< Data.
+};
+
+/**
+ * @brief       Command CommitConfig.
+ *
+ * The chunks written are applied and saved to eeprom if the config they make
+ * up matches the crc, otherwise they are discarded and all chunks have to be
+ * written again. Succeeds without change if the active config matches.
+ */
+struct CMDCommitConfig {
+    struct CMDHeader header; ///< Command header.
+    uint8_t crc; ///< config_chunk_crc() of the whole config at offset 0.
 };
 
 /**
@@ -226,6 +401,18 @@ struct CMDReadClock {
     struct CMDHeader header; ///< Command header.
 };
 
+/**
+ * @brief       Command SetBaudRate.
+ *
+ * The reply is sent at current baud rate, then the firmware switches to the
+ * new baud rate. The host confirms the link with two frames at the new baud
+ * rate, the second sent after the reply of the first has been received.
+ */
+struct CMDSetBaudRate {
+    struct CMDHeader header;   ///< Command header.
+    uint32_t         baudRate; ///< Baud rate.
+};
+
 /**
  * @brief       Reply Header.
  */
@@ -291,7 +478,40 @@ struct ReplyGetInputSpeed {
  */
 struct ReplyGetInputPWM {
     struct ReplyHeader header;    ///< Header.
-    uint8_t            dutyCycle; ///< Duty cycle, 1-100.
+    uint8_t            dutyCycle; ///< Duty cycle, 0-100.
+    uint16_t           frequency; ///< Frequency(HZ), 0 if level is constant.
+};
+
+/**
+ * @brief       Reply GetTelemetry.
+ */
+struct ReplyGetTelemetry {
+    struct ReplyHeader header;    ///< Header.
+    uint16_t           speed;     ///< Input speed(HZ).
+    uint8_t            dutyCycle; ///< Input duty cycle, 0-100.
+    uint16_t           frequency; ///< Input PWM frequency(HZ).
+    uint32_t           bootTime;  ///< Boot time.
+};
+
+/**
+ * @brief       Reply SubscribeTelemetry.
+ */
+struct ReplySubscribeTelemetry {
+    struct ReplyHeader header; ///< Header.
+};
+
+/**
+ * @brief       Reply SetSpeedMethod.
+ */
+struct ReplySetSpeedMethod {
+    struct ReplyHeader header; ///< Header.
+};
+
+/**
+ * @brief       Reply SetSpeedWindow.
+ */
+struct ReplySetSpeedWindow {
+    struct ReplyHeader header; ///< Header.
 };
 
 /**
@@ -312,8 +532,11 @@ struct ReplySetOutputPWM {
  * @brief       Reply ReadConfig.
  */
 struct ReplyReadConfig {
-    struct ReplyHeader    header; ///< Header.
-    struct FirmwareConfig config; ///< Config.
+    struct ReplyHeader header; ///< Header.
+    uint8_t            offset; ///< Offset of the chunk in FirmwareConfig.
+    uint8_t            length; ///< Size of the chunk.
+    uint8_t            crc;    ///< config_chunk_crc() of the chunk.
+    uint8_t            data[CONFIG_CHUNK_MAX_SIZE]; ///< Data.
 };
 
 /**
@@ -323,6 +546,13 @@ struct ReplyWriteConfig {
     struct ReplyHeader header; ///< Header.
 };
 
+/**
+ * @brief       Reply CommitConfig.
+ */
+struct ReplyCommitConfig {
+    struct ReplyHeader header; ///< Header.
+};
+
 /**
  * @brief       Reply ReadClock.
  */
@@ -331,6 +561,13 @@ struct ReplyReadClock {
     uint32_t           bootTime; ///< Boot time.
 };
 
-#if ! defined BUILD_FIRMWARE
+/**
+ * @brief       Reply SetBaudRate.
+ */
+struct ReplySetBaudRate {
+    struct ReplyHeader header; ///< Header.
+};
+
+#if ! defined BUILD_FIRMWARE || defined BUILD_SIMULATOR
     #pragma pack(pop)
 #endif